@@ -1,7 +1,12 @@
 #include <eosio/asset.hpp>
 #include <eosio/binary_extension.hpp>
+#include <eosio/crypto.hpp>
 #include <eosio/eosio.hpp>
 #include <eosio/singleton.hpp>
+#include <eosio/varint.hpp>
+#include <row_stream.hpp>
+#include <algorithm>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -24,6 +29,13 @@ namespace eosio {
             }
         };
 
+        // Bid quantity held for an auction (scoped by auction ID)
+        TABLE escrow {
+            asset balance;
+
+            uint64_t primary_key() const { return balance.symbol.code().raw(); }
+        };
+
         TABLE auction {
             uint64_t id;       // Round ID input
             symbol   symbol;   // Symbol of quantity to participate to this
@@ -31,28 +43,321 @@ namespace eosio {
             uint64_t status;
             // string   type;     // Type of auction (e.g. TENDER_TEN, MEGA_TENDER)
             // string status;   // Status of auction (e.g. BIDDING, WINNER_CALCULATION)
-            string prize;           // Prize (anything)
-            string public_key;      // Public key for bidding encrypted
-            name   winner;          // Winner account
-            string winner_number;   // Winner number chosen
-            string winner_txhash;   // Winner tx ID bid
-            string private_key;     // Private key for bidding decrypted
+            string      prize;           // Prize (anything)
+            public_key  public_key;      // Public key for bidding encrypted
+            name        winner;          // Winner account
+            uint64_t    winner_number;   // Winner number chosen
+            checksum256 winner_txhash;   // Winner tx ID bid
+            checksum256 private_key;     // Private key for bidding decrypted
+            asset       total_amount;    // Total quantity bid (pot)
+            uint64_t    bid_count;       // Number of bids (next bid sequence)
+            uint64_t    bidder_count;    // Number of distinct bidders
+            // Fields added after the first layout (missing in older rows, upgraded on modify)
+            binary_extension<uint64_t>   settled_count;   // Number of bids settled (next to settle)
+            binary_extension<asset>      ticket_price;    // Quantity to bid per number chosen
+            binary_extension<time_point> end_time;        // Time when bidding ends
+
+            uint64_t  primary_key() const { return id; }
+            uint64_t  get_symbol() const { return symbol.code().raw(); }
+            uint128_t get_status_type() const { return status_type_key(status, type, id); }
+
+            uint64_t get_settled_count() const {
+                return settled_count.has_value() ? settled_count.value() : 0;
+            }
+            // 0 for any quantity
+            asset get_ticket_price() const {
+                return ticket_price.has_value() ? ticket_price.value() : asset { 0, symbol };
+            }
+            // Never for auctions without an end time
+            time_point get_end_time() const {
+                return end_time.has_value() ? end_time.value()
+                                            : time_point(microseconds::maximum());
+            }
+
+            // Set missing fields to their defaults, so the row is written in the latest layout
+            void upgrade() {
+                settled_count = get_settled_count();
+                ticket_price  = get_ticket_price();
+                end_time      = get_end_time();
+            }
+
+            // Composite key ordered by status, type and then ID (below 2^32)
+            static uint128_t status_type_key(const uint64_t status, const uint64_t type,
+                                             const uint64_t id) {
+                return (static_cast<uint128_t>(status) << 64) | (type << 32) | id;
+            }
+        };
+
+        // Auction row stored as text before the fixed-size layout (to migrate)
+        TABLE legacy_auction {
+            uint64_t                   id;
+            symbol                     symbol;
+            uint64_t                   type;
+            uint64_t                   status;
+            string                     prize;
+            string                     public_key;
+            name                       winner;
+            string                     winner_number;
+            string                     winner_txhash;
+            string                     private_key;
+            binary_extension<asset>    total_amount;   // Missing in rows before aggregates
+            binary_extension<uint64_t> bid_count;
+            binary_extension<uint64_t> bidder_count;
 
             uint64_t primary_key() const { return id; }
-            uint64_t get_symbol() const { return symbol.code().raw(); }
             uint64_t get_type() const { return type; }
             uint64_t get_status() const { return status; }
         };
 
+#ifdef GETBIT_TEST_ACTIONS
+        // Auction in the text layout before aggregates (no extensions, so rows pack in a vector)
+        struct legacy_auction_seed {
+            uint64_t id;
+            symbol   symbol;
+            uint64_t type;
+            uint64_t status;
+            string   prize;
+            string   public_key;
+            name     winner;
+            string   winner_number;
+            string   winner_txhash;
+            string   private_key;
+        };
+#endif
+
+        TABLE bidding {
+            uint64_t id;           // Unique identifier of bid
+            uint64_t auction_id;   // Identifier of auction bid for
+            uint64_t sequence;     // Sequence of bid in the auction (from 0)
+            name     bidder;       // Bidder account
+            asset    quantity;     // Quantity bid
+            vector<char> entries;   // Original data entries (numbers chosen, see parse_numbers)
+            checksum256  hash;      // Hash of original data (sha256 of entries)
+
+            uint64_t  primary_key() const { return id; }
+            uint128_t get_auction_bidder() const {
+                return auction_key(auction_id, bidder.value);
+            }
+            uint128_t get_auction_sequence() const {
+                return auction_key(auction_id, sequence);
+            }
+
+            // Composite key ordered by auction first
+            static uint128_t auction_key(const uint64_t auction_id, const uint64_t low) {
+                return (static_cast<uint128_t>(auction_id) << 64) | low;
+            }
+        };
+
+        // Numbers chosen in an auction by buckets of 64 (scoped by auction ID)
+        TABLE number_bucket {
+            uint64_t         id;           // Bucket index (number / 64)
+            uint64_t         once;         // Bits of numbers chosen at least once
+            uint64_t         many;         // Bits of numbers chosen more than once
+            vector<uint64_t> first_bids;   // Bid ID first choosing each number of `once` (in bit order)
+
+            uint64_t primary_key() const { return id; }
+        };
+
+        TABLE archived {
+            uint64_t id;              // Round ID of auction
+            symbol   symbol;          // Symbol of quantity bid
+            uint64_t type;            // Type of auction
+            string   prize;           // Prize (anything)
+            name     winner;          // Winner account
+            uint64_t winner_number;   // Winner number chosen
+            asset    total_amount;    // Total quantity bid (pot)
+            uint64_t bid_count;       // Number of bids
+            uint64_t bidder_count;    // Number of distinct bidders
+
+            uint64_t primary_key() const { return id; }
+        };
+
+        // Scope of auctions with IDs in the same range (auctions are scoped by epoch)
+        TABLE epoch {
+            uint64_t id;              // Auction ID divided by AUCTION_EPOCH_SIZE (the scope)
+            uint64_t auction_count;   // Number of auctions not archived
+
+            uint64_t primary_key() const { return id; }
+        };
+
+        // Auction won by an account (scoped by winner)
+        TABLE win {
+            uint64_t auction_id;      // Identifier of auction
+            uint64_t type;            // Type of auction
+            string   prize;           // Prize (anything)
+            uint64_t winner_number;   // Winner number chosen
+            asset    total_amount;    // Total quantity bid (pot)
+            bool     archived;        // Whether the auction was moved to the archive table
+
+            uint64_t primary_key() const { return auction_id; }
+        };
+
+        // Auction joined by a bidder (scoped by bidder)
+        TABLE participation {
+            uint64_t auction_id;     // Identifier of auction
+            uint64_t bid_count;      // Number of bids in the auction
+            asset    total_amount;   // Total quantity bid in the auction
+
+            uint64_t primary_key() const { return auction_id; }
+        };
+
+        TABLE config {
+            vector<symbol_code>        symbols;    // Symbols registered by init
+            binary_extension<uint64_t> max_bids;     // Bids per bidder per auction (0 for no limit)
+            binary_extension<uint64_t> refund_bps;   // Rate of each bid not of the winner refunded in settle
+            binary_extension<uint64_t> payout_bps;   // Rate of the pot paid to the winner in settle
+        };
+
+        TABLE clearing {
+            name     table;    // Table being cleaned
+            uint64_t cursor;   // Primary key to resume cleaning from
+        };
+
+        TABLE migration {
+            uint64_t cursor;   // Legacy auction ID to resume migrating from
+        };
+
+        struct bid_entry {
+            uint64_t auction_id;   // Identifier of auction
+            asset    quantity;     // Quantity to bid
+            vector<char> entries;   // Original data entries (numbers chosen, see parse_numbers)
+            checksum256  hash;      // Hash of original data (sha256 of entries)
+        };
+
+        // Receipt of a bid (returned to the bidder)
+        struct bid_receipt {
+            uint64_t auction_id;   // Identifier of auction
+            uint64_t sequence;     // Sequence of the bid in the auction
+            asset    balance;      // Balance of the bidder remaining after the bid
+            asset    pot;          // Total quantity bid for the auction up to the bid
+        };
+
+        struct winner_entry {
+            uint64_t    id;              // Identifier of auction
+            name        winner;          // Winner account
+            uint64_t    winner_number;   // Winner number chosen by winner
+            checksum256 winner_txhash;   // Transaction hash of bidding from winner
+            checksum256 private_key;     // Private key used in the auction
+        };
+
+        struct batch_failure {
+            uint64_t id;      // Identifier of auction failed
+            string   error;   // Error message
+        };
+
+        // Auction summary returned by queries
+        struct auction_view {
+            uint64_t   id;             // Identifier of auction
+            uint64_t   status;         // Status of auction (bidding past its end time as ended)
+            uint64_t   type;           // Type of auction
+            string     prize;          // Prize (anything)
+            name       winner;         // Winner account
+            asset      total_amount;   // Total quantity bid (pot)
+            uint64_t   bid_count;      // Number of bids
+            uint64_t   bidder_count;   // Number of distinct bidders
+            asset      ticket_price;   // Quantity to bid per number chosen
+            time_point end_time;       // Time when bidding ends
+        };
+
+        struct auction_page {
+            vector<auction_view> rows;          // Auctions in ID order
+            bool                 more;          // Whether auctions are left after this page
+            uint64_t             next_cursor;   // ID to query the next page from
+        };
+
         typedef eosio::multi_index<"account"_n, account> accounts;
         typedef eosio::multi_index<"stat"_n, stat>       stats;
+        typedef eosio::multi_index<"escrow"_n, escrow>   escrows;
         typedef eosio::multi_index<
-            "auction"_n, auction, indexed_by<"bytype"_n, const_mem_fun<auction, uint64_t, &auction::get_type>>,
-            indexed_by<"bystatus"_n, const_mem_fun<auction, uint64_t, &auction::get_status>>>
+            "auctionv2"_n, auction,
+            indexed_by<"bystatustype"_n, const_mem_fun<auction, uint128_t, &auction::get_status_type>>>
             auctions;
+        typedef eosio::multi_index<
+            "auction"_n, legacy_auction,
+            indexed_by<"bytype"_n, const_mem_fun<legacy_auction, uint64_t, &legacy_auction::get_type>>,
+            indexed_by<"bystatus"_n, const_mem_fun<legacy_auction, uint64_t, &legacy_auction::get_status>>>
+            legacy_auctions;
+        typedef eosio::multi_index<
+            "bid"_n, bidding,
+            indexed_by<"byauctbidder"_n, const_mem_fun<bidding, uint128_t, &bidding::get_auction_bidder>>,
+            indexed_by<"byauctseq"_n, const_mem_fun<bidding, uint128_t, &bidding::get_auction_sequence>>>
+            bids;
+        typedef eosio::multi_index<"number"_n, number_bucket> number_buckets;
+        typedef eosio::multi_index<"archive"_n, archived>  archives;
+        typedef row_stream<"bid"_n, bidding, 2>           bid_stream;
+        typedef row_stream<"auctionv2"_n, auction, 1>     auction_stream;
+        typedef row_stream<"number"_n, number_bucket>     number_stream;
+        typedef row_stream<"archive"_n, archived>         archive_stream;
+        typedef eosio::multi_index<"joined"_n, participation> participations;
+        typedef eosio::multi_index<"epoch"_n, epoch>          epochs;
+        typedef eosio::multi_index<"win"_n, win>              wins;
+        typedef eosio::singleton<"clearing"_n, clearing> clearings;
+        typedef eosio::singleton<"config"_n, config>     configs;
+        typedef eosio::singleton<"migration"_n, migration> migrations;
+
+        /**
+         * @brief Balances of an action, loaded at most once per row and written
+         * back once per row when flushed (at the end of the action).
+         */
+        class balance_cache {
+          public:
+            balance_cache(const name &code) : _code(code) {}
+
+            asset get(const name &owner, const symbol_code &symbol_code);
+            void  add(const name &owner, const asset &value);
+            void  sub(const name &owner, const asset &value);
+            void  flush();
+
+          private:
+            struct entry {
+                accounts table;
+                asset    balance;
+                bool     opened = false;   // Whether the row is in the table or to be added
+                bool     dirty  = false;   // Whether the balance is to be written back
+
+                entry(const name &code, const name &owner) : table(code, owner.value) {}
+            };
+
+            entry &load(const name &owner, const symbol_code &symbol_code);
+
+            name                                  _code;
+            map<pair<uint64_t, uint64_t>, entry> _entries;   // By (owner, symbol code)
+        };
+
+        balance_cache _balances;
+
+        /**
+         * @brief Global config of an action, read at most once and written back
+         * once when changed (at the end of the action).
+         */
+        class config_cache {
+          public:
+            config_cache(const name &code) : _code(code), _table(code, code.value) {}
+
+            bool     has_symbol(const symbol_code &symbol_code);
+            void     add_symbol(const symbol_code &symbol_code);
+            uint64_t max_bids();
+            void     set_max_bids(const uint64_t max_bids);
+            uint64_t refund_bps();
+            uint64_t payout_bps();
+            void     set_settle_rates(const uint64_t refund_bps, const uint64_t payout_bps);
+            void flush();
+
+          private:
+            config &load();
+
+            name    _code;
+            configs _table;
+            config  _config {};
+            bool    _loaded = false;
+            bool    _dirty  = false;   // Whether the config is to be written back
+        };
+
+        config_cache _config;
 
         /**
          * @brief Add the balance of an account (if the balance does not exist, initiate the balance as zero).
+         * The change is kept in the balance cache until the end of the action.
          *
          * @param owner - Owner account of the balance.
          * @param value - The amount to add to the balance.
@@ -76,18 +381,276 @@ namespace eosio {
          */
         asset get_balance(const name &owner, const symbol_code &symbol_code);
 
-        // Clean the table
-        template <typename T> void clean_table(name self, uint64_t scope = 0) {
-            uint64_t s = scope ? scope : self.value;
-            T        db(self, s);
-            while (db.begin() != db.end()) {
-                auto itr = --db.end();
-                db.erase(itr);
+        /**
+         * @brief Parse 32 bytes in hex text (empty text as zero).
+         *
+         * @param hex - Hex text of 64 characters.
+         * @param value - Parsed bytes (zero if not parsed).
+         * @return bool - Whether the text was parsed.
+         */
+        static bool parse_checksum256(const string &hex, checksum256 &value);
+
+        /**
+         * @brief Parse a number in decimal text (empty text as zero).
+         *
+         * @param text - Decimal text.
+         * @param value - Parsed number (zero if not parsed).
+         * @return bool - Whether the text was parsed.
+         */
+        static bool parse_number(const string &text, uint64_t &value);
+
+        /**
+         * @brief Parse a K1 public key in legacy (EOS) or PUB_K1_ text (empty text as zero).
+         *
+         * @param text - Public key text.
+         * @param value - Parsed public key (zero if not parsed).
+         * @return bool - Whether the text was parsed.
+         */
+        static bool parse_public_key(const string &text, public_key &value);
+
+        /**
+         * @brief Parse a K1 private key in WIF, PVT_K1_ or hex text (empty text as zero).
+         *
+         * @param text - Private key text.
+         * @param value - Parsed 32 bytes of the key (zero if not parsed).
+         * @return bool - Whether the text was parsed.
+         */
+        static bool parse_private_key(const string &text, checksum256 &value);
+
+        /**
+         * @brief Decode base58 text into bytes of a fixed size (leading bytes zero).
+         *
+         * @param text - Base58 text.
+         * @param bytes - Decoded bytes.
+         * @param size - Number of bytes.
+         * @return bool - Whether the text was decoded within the size.
+         */
+        static bool parse_base58(const string &text, uint8_t *bytes, const size_t size);
+
+        /**
+         * @brief End bidding of the auction.
+         *
+         * @param auction_table - Auction table of the epoch of the auction (see auctions_of).
+         * @param id - Identifier of auction.
+         * @return string - Error message (empty when ended).
+         */
+        string end_bidding(auctions &auction_table, const uint64_t id);
+
+        /**
+         * @brief Select winner of the auction (the escrow of the auction is swept to the contract).
+         *
+         * @param auction_table - Auction table of the epoch of the auction (see auctions_of).
+         * @param entry - Winner of auction.
+         * @return string - Error message (empty when selected).
+         */
+        string select_winner(auctions &auction_table, const winner_entry &entry);
+
+        /**
+         * @brief Compute winner of TENDER_TEN auction as the bidder of the lowest
+         * number chosen only once (from the number buckets of the auction).
+         *
+         * @param id - Identifier of auction.
+         * @return pair<name, uint64_t> - Winner and winner number (the contract and 0
+         * if no number is chosen only once).
+         */
+        pair<name, uint64_t> compute_winner(const uint64_t id);
+
+        /**
+         * @brief Get the auction table of the epoch of the auction.
+         *
+         * @param id - Identifier of auction.
+         * @return auctions - Auction table scoped by the epoch.
+         */
+        auctions auctions_of(const uint64_t id);
+
+        /**
+         * @brief Count the auction in its epoch (the epoch is added if it does not exist).
+         *
+         * @param id - Identifier of auction.
+         */
+        void add_epoch_auction(const uint64_t id);
+
+        /**
+         * @brief Clean auctions of all epochs from the cursor with their number buckets
+         * (epochs cleaned are dropped).
+         *
+         * @param cursor - Auction ID to resume cleaning from (updated to resume next).
+         * @param max_rows - Maximum rows to erase (decreased by rows erased).
+         * @return bool - Whether all auctions were cleaned.
+         */
+        bool clean_auctions(uint64_t &cursor, uint64_t &max_rows);
+
+        /**
+         * @brief Count auctions of all epochs with their number buckets forward from the
+         * cursor up to the limit.
+         *
+         * @param cursor - Auction ID to start from.
+         * @param limit - Maximum rows to count.
+         * @return uint64_t - Number of rows counted.
+         */
+        uint64_t count_auctions(const uint64_t cursor, const uint64_t limit);
+
+        /**
+         * @brief Get the part of the quantity at the rate (rounded down).
+         *
+         * @param quantity - Quantity to take the part of.
+         * @param bps - Rate in basis points (of RATE_BPS_MAX).
+         * @return asset - Part of the quantity.
+         */
+        asset rate_of(const asset &quantity, const uint64_t bps) const;
+
+        /**
+         * @brief Get the status of the auction, taking bidding past its end time
+         * as ended (the status is stored when the auction is modified next).
+         *
+         * @param a - Auction.
+         * @return uint64_t - Status of auction.
+         */
+        uint64_t auction_status(const auction &a) const;
+
+        /**
+         * @brief Parse and validate numbers chosen in entries in one pass. Entries of
+         * version 1 are the count and the ascending numbers as differences from the
+         * previous one (from zero for the first), all in varint.
+         *
+         * @param entries - Original data entries.
+         * @return vector<uint64_t> - Numbers chosen.
+         */
+        vector<uint64_t> parse_numbers(const vector<char> &entries);
+
+        /**
+         * @brief Count numbers chosen in buckets of the auction (each bucket is written once).
+         *
+         * @param auction_id - Identifier of auction.
+         * @param choices - Pairs of number chosen and bid ID (in bid order).
+         */
+        void count_numbers(const uint64_t auction_id, vector<pair<uint64_t, uint64_t>> &choices);
+
+        /**
+         * @brief Erase all number buckets of the auction.
+         *
+         * @param auction_id - Identifier of auction.
+         */
+        void erase_numbers(const uint64_t auction_id);
+
+        /**
+         * @brief Move the escrow of the auction to the contract balance (if any).
+         *
+         * @param auction_id - Identifier of auction.
+         * @param symbol - Symbol of the escrow.
+         */
+        void sweep_escrow(const uint64_t auction_id, const symbol &symbol);
+
+        /**
+         * @brief Refund the bid to the bidder from the escrow of its auction
+         * (if the escrow was not swept).
+         *
+         * @param b - Bid to refund.
+         */
+        void refund_escrow(const bidding &b);
+
+        /**
+         * @brief Erase the participation of a bidder in an auction (if any).
+         *
+         * @param bidder - Bidder account.
+         * @param auction_id - Identifier of auction.
+         */
+        void erase_participation(const name &bidder, const uint64_t auction_id);
+
+        /**
+         * @brief Add the auction to the wins of its winner (unless the winner is the contract).
+         *
+         * @param a - Auction with winner selected.
+         */
+        void add_win(const auction &a);
+
+        /**
+         * @brief Erase the win of an account in an auction (if any).
+         *
+         * @param winner - Winner account.
+         * @param auction_id - Identifier of auction.
+         */
+        void erase_win(const name &winner, const uint64_t auction_id);
+
+        /**
+         * @brief Apply bids of a bidder at once (each auction is checked once,
+         * the bidder is debited once and the escrow of each auction is credited
+         * once), record them in the bid table and update aggregates of each auction.
+         * The hash of each bid is verified against its entries.
+         *
+         * @param bidder - Bidder account.
+         * @param items - Bids to apply.
+         * @return vector<bid_receipt> - Receipts in the order of items.
+         */
+        vector<bid_receipt> apply_bids(const name &bidder, const vector<bid_entry> &items);
+
+        /**
+         * @brief Clean the table forward from the cursor within the row limit, streaming
+         * rows so memory does not grow with the rows erased.
+         *
+         * @param scope - Scope of the table.
+         * @param cursor - Primary key to start from (updated to the next row left).
+         * @param max_rows - Maximum rows to erase (decreased by the rows erased).
+         * @param on_erase - Function called with each row before it is erased.
+         * @return bool - Whether no row is left from the cursor.
+         */
+        template <typename Stream, typename Lambda>
+        bool clean_table(const uint64_t scope, uint64_t &cursor, uint64_t &max_rows,
+                         Lambda &&on_erase) {
+            Stream rows(get_self(), scope, cursor);
+            while (rows) {
+                if (max_rows == 0) {
+                    cursor = rows->primary_key();
+                    return false;
+                }
+                on_erase(*rows);
+                rows.erase();
+                max_rows--;
+            }
+            return true;
+        };
+
+        /**
+         * @brief Modify the auction, upgrading the row to the latest layout first.
+         *
+         * @param auction_table - Auction table.
+         * @param itr - Auction to modify.
+         * @param updater - Function to update the auction.
+         */
+        template <typename Lambda>
+        void modify_auction(auctions &auction_table, const auctions::const_iterator &itr,
+                            Lambda &&updater) {
+            auction_table.modify(itr, get_self(), [&](auction &a) {
+                a.upgrade();
+                updater(a);
+            });
+        };
+
+        /**
+         * @brief Count rows forward from the cursor up to the limit.
+         *
+         * @param scope - Scope of the table.
+         * @param cursor - Primary key to start from.
+         * @param limit - Maximum rows to count.
+         * @return uint64_t - Number of rows counted.
+         */
+        template <typename Stream>
+        uint64_t count_rows(const uint64_t scope, const uint64_t cursor, const uint64_t limit) {
+            uint64_t count = 0;
+            for (Stream rows(get_self(), scope, cursor); rows && count < limit; ++rows) {
+                count++;
             }
+            return count;
         };
 
       public:
-        using contract::contract;
+        getbit(name receiver, name code, datastream<const char *> ds)
+            : contract(receiver, code, ds), _balances(receiver), _config(receiver) {}
+
+        ~getbit() {
+            _balances.flush();
+            _config.flush();
+        }
 
         const string   AUCTION_TYPE_0                      = "TENDER_TEN";
         const uint64_t AUCTION_TYPE_0_TENDER_TEN           = 0;
@@ -96,13 +659,23 @@ namespace eosio {
         const uint64_t AUCTION_STATUS_0_BIDDING            = 0;
         const uint64_t AUCTION_STATUS_1_WINNER_CALCULATION = 1;
         const uint64_t AUCTION_STATUS_2_WINNER_SELECTED    = 2;
+        const uint64_t AUCTION_STATUS_3_SETTLED            = 3;
+        const uint64_t AUCTION_NUMBER_MAX                  = 9999;   // Numbers chosen are 0 to this
+        const uint64_t NUMBER_BUCKET_SIZE                  = 64;
+        const uint8_t  ENTRIES_VERSION_1_DELTA_LIST        = 1;
+        const uint64_t AUCTION_EPOCH_SIZE                  = 1000;   // Auction IDs in a scope
+        const uint64_t QUERY_LIMIT_MAX                     = 100;   // Rows returned by a query at most
+        const uint64_t RATE_BPS_MAX                        = 10000;   // Rate of 100% in basis points
 
-        ACTION clear() {
-            require_auth(get_self());
-            printl("cleaning", 8);
-
-            clean_table<auctions>(get_self(), get_self().value);
-        }
+        /**
+         * @brief Clean the bid, auction and archive tables in chunks (resumed from the stored cursor).
+         * Bids are refunded from escrows not swept, escrows left are swept to the contract, and
+         * number buckets of each auction are erased with it (counted as rows).
+         *
+         * @param max_rows - Maximum rows to erase in this call (0 for no limit).
+         * @return uint64_t - Rows remaining to clean (counted up to max_rows, 0 when done).
+         */
+        [[eosio::action]] uint64_t clear(const uint64_t &max_rows);
 
         /**
          * @brief Initiate supply with a new symbol.
@@ -121,6 +694,16 @@ namespace eosio {
         ACTION charge(const name &from, const name &to, const asset &quantity,
                       const string &memo);
 
+        /**
+         * @brief Charge(transfer) new tokens to many accounts at once.
+         *
+         * @param from - Sending account (debited once for the total).
+         * @param transfers - Pairs of receiving account and quantity (all in the same symbol).
+         * @param memo - Memo (max 256 bytes).
+         */
+        ACTION chargebatch(const name &from, const vector<pair<name, asset>> &transfers,
+                           const string &memo);
+
         /**
          * @brief Open an account to be initiated.
          *
@@ -129,6 +712,22 @@ namespace eosio {
          */
         ACTION open(const name &owner, const symbol &symbol);
 
+        /**
+         * @brief Set the maximum bids per bidder in an auction.
+         *
+         * @param max_bids - Maximum bids (0 for no limit).
+         */
+        ACTION setmaxbids(const uint64_t &max_bids);
+
+        /**
+         * @brief Set the rates settle pays out and refunds at (both 0 until set, and
+         * at most 10000 in total so no more than the pot is paid out).
+         *
+         * @param refund_bps - Rate of each bid not of the winner refunded to its bidder (basis points).
+         * @param payout_bps - Rate of the pot paid to the winner (basis points).
+         */
+        ACTION setsettle(const uint64_t &refund_bps, const uint64_t &payout_bps);
+
         /**
          * @brief Start auction.
          *
@@ -137,49 +736,174 @@ namespace eosio {
          * @param type - Type of auction.
          * @param prize - Prize of auction (indication).
          * @param public_key - Public key used in bidding.
+         * @param ticket_price - Quantity to bid per number chosen.
+         * @param end_time - Time when bidding ends (without biddingend).
          */
         ACTION biddingstart(const uint64_t &id, const symbol &symbol, const string &type,
-                            const string &prize, const string &public_key);
+                            const string &prize, const public_key &public_key,
+                            const asset &ticket_price, const time_point &end_time);
 
         /**
          * @brief Bid for the auction.
          *
          * @param bidder - Bidder account (caller).
          * @param auction_id - Identifier of auction.
-         * @param quantity - Quantity to bid.
-         * @param entries - Original data entries.
-         * @param hash - Hash of original data to check the integrity.
+         * @param quantity - Quantity to bid (the ticket price times the numbers chosen).
+         * @param entries - Original data entries (numbers chosen).
+         * @param hash - Hash of original data to check the integrity (sha256 of entries, verified).
+         * @return bid_receipt - Sequence of the bid, balance remaining and pot of the auction.
+         */
+        [[eosio::action]] bid_receipt bid(const name &bidder, const uint64_t &auction_id,
+                                          const asset &quantity, const vector<char> &entries,
+                                          const checksum256 &hash);
+
+        /**
+         * @brief Bid for several auctions (or several times) in one action.
+         *
+         * @param bidder - Bidder account (caller).
+         * @param items - Bids to apply (all in the same symbol).
+         * @return vector<bid_receipt> - Receipts in the order of items.
          */
-        ACTION bid(const name &bidder, const uint64_t &auction_id,
-                   const asset &quantity, const string &entries, const string &hash);
+        [[eosio::action]] vector<bid_receipt> bidbatch(const name              &bidder,
+                                                       const vector<bid_entry> &items);
 
         /**
-         * @brief End auction by ID.
+         * @brief End auction by ID (before its end time).
          *
          * @param id - Identifier of auction.
          */
         ACTION biddingend(const uint64_t &id);
 
         /**
-         * @brief Select winner of the auction.
+         * @brief End auctions by IDs at once.
+         *
+         * @param ids - Identifiers of auctions.
+         * @param skip_failures - Whether to skip auctions failed (or to fail all).
+         * @return vector<batch_failure> - Auctions failed with errors.
+         */
+        [[eosio::action]] vector<batch_failure> biddingends(const vector<uint64_t> &ids,
+                                                            const bool &skip_failures);
+
+        /**
+         * @brief Compute winner of TENDER_TEN auction as the bidder of the lowest
+         * number chosen only once (anyone can compute and check).
+         *
+         * @param id - Identifier of auction.
+         */
+        ACTION calcwinner(const uint64_t &id);
+
+        /**
+         * @brief Select winner of the auction (the escrow of the auction is swept to the contract).
+         * The winner of TENDER_TEN auction must be the one computed, or the contract with
+         * number 0 if no number is chosen only once.
          *
          * @param id - Identifier of auction.
          * @param winner - Winner account.
          * @param winner_number - Winner number chosen by winner.
          * @param winner_txhash - Transaction hash of bidding from winner.
-         * @param private_key - Private key used in this auction (announcement).
+         * @param private_key - Private key used in this auction (announcement, 32 bytes).
+         */
+        ACTION selectwinner(const uint64_t &id, const name &winner, const uint64_t &winner_number,
+                            const checksum256 &winner_txhash, const checksum256 &private_key);
+
+        /**
+         * @brief Select winners of auctions at once.
+         *
+         * @param winners - Winners of auctions.
+         * @param skip_failures - Whether to skip auctions failed (or to fail all).
+         * @return vector<batch_failure> - Auctions failed with errors.
+         */
+        [[eosio::action]] vector<batch_failure> selwinners(const vector<winner_entry> &winners,
+                                                           const bool &skip_failures);
+
+        /**
+         * @brief Settle bids of the auction with winner selected in sequence order, at the
+         * rates set by setsettle when each chunk is settled. Each bid not of the winner is
+         * refunded at the refund rate, and the winner is paid the pot at the payout rate
+         * when no bid is left (the rest of the pot is kept by the contract, and the rates
+         * together never pay out more than the pot). Resumed from
+         * the last bid settled, and the auction is settled when no bid is left.
+         *
+         * @param auction_id - Identifier of auction.
+         * @param max_rows - Maximum bids to settle in this call.
+         */
+        ACTION settle(const uint64_t &auction_id, const uint64_t &max_rows);
+
+        /**
+         * @brief Move settled auctions to the archive table (winner summary only).
+         *
+         * @param max_rows - Maximum auctions to archive in this call.
+         */
+        ACTION archive(const uint64_t &max_rows);
+
+        /**
+         * @brief Migrate auctions stored as text to the fixed-size layout (resumed from
+         * the last auction visited). Auctions with fields that cannot be parsed, or that
+         * cannot be stored in the new layout, are left in the text layout.
+         *
+         * @param max_rows - Maximum auctions to visit in this call.
+         * @return vector<batch_failure> - Auctions left in the text layout.
+         */
+        [[eosio::action]] vector<batch_failure> migrate(const uint64_t &max_rows);
+
+#ifdef GETBIT_TEST_ACTIONS
+        /**
+         * @brief Store auctions in the text layout to be migrated (built for tests only).
+         *
+         * @param rows - Auctions in the text layout.
+         */
+        ACTION putlegacy(const vector<legacy_auction_seed> &rows);
+#endif
+
+        /**
+         * @brief Get a page of auctions by status and type (read only, anyone can query).
+         * Bidding past its end time is found as ended, as reported by each row.
+         *
+         * @param status - Status of auctions.
+         * @param type - Type of auctions.
+         * @param cursor - ID to start the page from (next_cursor of the previous page, below 2^32).
+         * @param limit - Maximum auctions in the page.
+         * @return auction_page - Auctions found and the cursor of the next page.
+         */
+        [[eosio::action]] auction_page getauctions(const uint64_t &status, const uint64_t &type,
+                                                   const uint64_t &cursor, const uint64_t &limit);
+
+        /**
+         * @brief Get balances of accounts (read only, anyone can query).
+         *
+         * @param owners - Accounts to get balances of.
+         * @param symbol - Symbol of balances.
+         * @return vector<asset> - Balances in the order of owners (zero for accounts not opened).
          */
-        ACTION selectwinner(const uint64_t &id, const name &winner, const string &winner_number,
-                            const string &winner_txhash, const string &private_key);
+        [[eosio::action]] vector<asset> getbalances(const vector<name> &owners,
+                                                    const symbol       &symbol);
 
+        using clear_action = eosio::action_wrapper<"clear"_n, &getbit::clear>;
+        using archive_action = eosio::action_wrapper<"archive"_n, &getbit::archive>;
         using init_action = eosio::action_wrapper<"init"_n, &getbit::init>;
         using charge_action = eosio::action_wrapper<"charge"_n, &getbit::charge>;
+        using chargebatch_action
+            = eosio::action_wrapper<"chargebatch"_n, &getbit::chargebatch>;
         using open_action = eosio::action_wrapper<"open"_n, &getbit::open>;
+        using setmaxbids_action = eosio::action_wrapper<"setmaxbids"_n, &getbit::setmaxbids>;
+        using setsettle_action = eosio::action_wrapper<"setsettle"_n, &getbit::setsettle>;
         using biddingstart_action
             = eosio::action_wrapper<"biddingstart"_n, &getbit::biddingstart>;
+        using biddingends_action = eosio::action_wrapper<"biddingends"_n, &getbit::biddingends>;
         using biddingend_action = eosio::action_wrapper<"biddingend"_n, &getbit::biddingend>;
         using bid_action = eosio::action_wrapper<"bid"_n, &getbit::bid>;
+        using bidbatch_action = eosio::action_wrapper<"bidbatch"_n, &getbit::bidbatch>;
+        using calcwinner_action
+            = eosio::action_wrapper<"calcwinner"_n, &getbit::calcwinner>;
         using selectwinner_action
             = eosio::action_wrapper<"selectwinner"_n, &getbit::selectwinner>;
+        using selwinners_action = eosio::action_wrapper<"selwinners"_n, &getbit::selwinners>;
+        using settle_action = eosio::action_wrapper<"settle"_n, &getbit::settle>;
+        using migrate_action = eosio::action_wrapper<"migrate"_n, &getbit::migrate>;
+#ifdef GETBIT_TEST_ACTIONS
+        using putlegacy_action = eosio::action_wrapper<"putlegacy"_n, &getbit::putlegacy>;
+#endif
+        using getauctions_action = eosio::action_wrapper<"getauctions"_n, &getbit::getauctions>;
+        using getbalances_action = eosio::action_wrapper<"getbalances"_n, &getbit::getbalances>;
     };
 }   // namespace eosio
\ No newline at end of file
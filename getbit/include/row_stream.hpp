@@ -0,0 +1,155 @@
+#pragma once
+
+#include <eosio/check.hpp>
+#include <eosio/datastream.hpp>
+#include <eosio/multi_index.hpp>
+#include <eosio/name.hpp>
+#include <vector>
+
+namespace eosio {
+    /**
+     * @brief Forward stream of table rows walked with the database API directly, by
+     * primary key or by a secondary index. Unlike multi_index, which keeps every row it
+     * loads until it is destroyed, each row is unpacked into the same buffer when read,
+     * so scanning and erasing any number of rows takes constant memory.
+     *
+     * Secondary indices of the table must all be uint128, numbered from 0 in the order
+     * declared in its multi_index. A multi_index of the same table must not be in use
+     * while rows are erased through the stream (its cached rows would go stale).
+     *
+     * @tparam TableName - Name of the table.
+     * @tparam T - Type of the rows.
+     * @tparam SecondaryCount - Number of secondary indices of the table.
+     */
+    template <name::raw TableName, typename T, uint64_t SecondaryCount = 0>
+    class row_stream {
+      public:
+        /**
+         * @brief Stream rows by primary key from the lower bound.
+         *
+         * @param code - Account owning the table.
+         * @param scope - Scope of the table.
+         * @param lower - Primary key to start from.
+         */
+        row_stream(const name &code, const uint64_t scope, const uint64_t lower)
+            : _code(code), _scope(scope), _index(PRIMARY) {
+            _itr = internal_use_do_not_use::db_lowerbound_i64(_code.value, _scope, table_name(),
+                                                              lower);
+        }
+
+        /**
+         * @brief Stream rows by a secondary index from the lower bound.
+         *
+         * @param code - Account owning the table.
+         * @param scope - Scope of the table.
+         * @param index - Number of the secondary index.
+         * @param lower - Secondary key to start from.
+         */
+        row_stream(const name &code, const uint64_t scope, const uint64_t index,
+                   const uint128_t lower)
+            : _code(code), _scope(scope), _index(index) {
+            check(index < SecondaryCount, "Secondary index does not exist");
+            uint128_t secondary = lower;
+            uint64_t  primary   = 0;
+            _index_itr = internal_use_do_not_use::db_idx128_lowerbound(
+                _code.value, _scope, index_name(_index), &secondary, &primary);
+            find(primary);
+        }
+
+        row_stream(const row_stream &) = delete;
+        row_stream &operator=(const row_stream &) = delete;
+
+        /**
+         * @brief Whether the stream is at a row (not past the last one).
+         */
+        explicit operator bool() const { return _itr >= 0; }
+
+        const T &operator*() const {
+            load();
+            return _row;
+        }
+
+        const T *operator->() const {
+            load();
+            return &_row;
+        }
+
+        /**
+         * @brief Move to the next row.
+         */
+        row_stream &operator++() {
+            check(_itr >= 0, "Cannot increment past the last row");
+            uint64_t primary = 0;
+            if (_index == PRIMARY) {
+                _itr = internal_use_do_not_use::db_next_i64(_itr, &primary);
+            } else {
+                _index_itr = internal_use_do_not_use::db_idx128_next(_index_itr, &primary);
+                find(primary);
+            }
+            _loaded = false;
+            return *this;
+        }
+
+        /**
+         * @brief Erase the row with its secondary keys and move to the next row.
+         */
+        void erase() {
+            check(_itr >= 0, "Cannot erase past the last row");
+            const int32_t  itr     = _itr;
+            const uint64_t primary = SecondaryCount > 0 ? (**this).primary_key() : 0;
+            ++(*this);
+
+            for (uint64_t index = 0; index < SecondaryCount; index++) {
+                uint128_t     secondary = 0;
+                const int32_t index_itr = internal_use_do_not_use::db_idx128_find_primary(
+                    _code.value, _scope, index_name(index), &secondary, primary);
+                check(index_itr >= 0, "Secondary key of the row does not exist");
+                internal_use_do_not_use::db_idx128_remove(index_itr);
+            }
+            internal_use_do_not_use::db_remove_i64(itr);
+        }
+
+      private:
+        static constexpr uint64_t PRIMARY = UINT64_MAX;
+
+        static constexpr uint64_t table_name() { return static_cast<uint64_t>(TableName); }
+
+        // Secondary tables are named as multi_index names them
+        static constexpr uint64_t index_name(const uint64_t index) {
+            return (table_name() & 0xFFFFFFFFFFFFFFF0ULL) | (index & 0x000000000000000FULL);
+        }
+
+        void find(const uint64_t primary) {
+            _itr = _index_itr >= 0
+                       ? internal_use_do_not_use::db_find_i64(_code.value, _scope, table_name(),
+                                                              primary)
+                       : -1;
+        }
+
+        void load() const {
+            if (_loaded) {
+                return;
+            }
+            check(_itr >= 0, "Cannot read past the last row");
+            const auto size = internal_use_do_not_use::db_get_i64(_itr, nullptr, 0);
+            check(size >= 0, "Error reading row");
+            _buffer.resize(size);
+            internal_use_do_not_use::db_get_i64(_itr, _buffer.data(), size);
+
+            // Reset first, as fields left unread (extensions) keep their values
+            _row = T {};
+            datastream<const char *> ds(_buffer.data(), _buffer.size());
+            ds >> _row;
+            _loaded = true;
+        }
+
+        name           _code;
+        uint64_t       _scope;
+        uint64_t       _index;
+        int32_t        _itr       = -1;
+        int32_t        _index_itr = -1;
+        mutable bool   _loaded    = false;
+        mutable T      _row;
+        mutable std::vector<char> _buffer;
+    };
+} // namespace eosio
@@ -1,6 +1,50 @@
 #include <getbit.hpp>
 
 namespace eosio {
+    uint64_t getbit::clear(const uint64_t &max_rows) {
+        require_auth(get_self());
+
+        clearings clearing_table(get_self(), get_self().value);
+        clearing  state = clearing_table.get_or_default(clearing { "bid"_n, 0 });
+
+        // Tables are cleaned in order: bid, auction, archive (bids are refunded
+        // from escrows not swept before their auctions are cleaned)
+        uint64_t rows_left = max_rows == 0 ? UINT64_MAX : max_rows;
+        if (state.table == "bid"_n
+            && clean_table<bid_stream>(get_self().value, state.cursor, rows_left,
+                                 [&](const bidding &b) {
+                                     erase_participation(b.bidder, b.auction_id);
+                                     refund_escrow(b);
+                                 })) {
+            state = clearing { "auctionv2"_n, 0 };
+        }
+        if (state.table == "auctionv2"_n && clean_auctions(state.cursor, rows_left)) {
+            state = clearing { "archive"_n, 0 };
+        }
+        if (state.table == "archive"_n
+            && clean_table<archive_stream>(get_self().value, state.cursor, rows_left,
+                                     [&](const archived &a) { erase_win(a.winner, a.id); })) {
+            if (clearing_table.exists()) {
+                clearing_table.remove();
+            }
+            return 0;
+        }
+        clearing_table.set(state, get_self());
+
+        uint64_t remaining = 0;
+        if (state.table == "bid"_n) {
+            remaining += count_rows<bid_stream>(get_self().value, state.cursor, max_rows);
+            state = clearing { "auctionv2"_n, 0 };
+        }
+        if (state.table == "auctionv2"_n) {
+            remaining += count_auctions(state.cursor, max_rows - remaining);
+            state = clearing { "archive"_n, 0 };
+        }
+        remaining
+            += count_rows<archive_stream>(get_self().value, state.cursor, max_rows - remaining);
+        return remaining;
+    }
+
     ACTION getbit::init(const asset &max_supply) {
         require_auth(get_self());
 
@@ -16,20 +60,12 @@ namespace eosio {
         check(symbol.is_valid(), "Invalid symbol");
         check(symbol.precision() == 0, "Precision must be a zero");
 
-        stats      stat_table(get_self(), get_self().value);
-        const auto existing_stat = stat_table.find(symbol.code().raw());
-        check(existing_stat == stat_table.end(), "Symbol already exists");
+        check(!_config.has_symbol(symbol.code()), "Symbol already exists");
 
+        stats stat_table(get_self(), get_self().value);
         stat_table.emplace(get_self(),
                            [&](stat &s) { s.max_supply = max_supply_asset; });
-
-        accounts   account_table(get_self(), get_self().value);
-        const auto existing_account = account_table.find(symbol.code().raw());
-        if (existing_account == account_table.end()) {
-            account_table.emplace(get_self(), [&](auto &a) {
-                a.balance = asset { 0, symbol };
-            });
-        }
+        _config.add_symbol(symbol.code());
 
         add_balance(get_self(), max_supply_asset);
     }
@@ -48,10 +84,7 @@ namespace eosio {
         check(symbol.is_valid(), "Invalid symbol");
         check(symbol.precision() == 0, "Precision must be a zero");
 
-        stats      stat_table(get_self(), get_self().value);
-        const auto existing_stat = stat_table.find(symbol.code().raw());
-        check(existing_stat != stat_table.end(),
-              "Symbol does not exist, create before");
+        check(_config.has_symbol(symbol.code()), "Symbol does not exist, create before");
 
         require_recipient(from);
         require_recipient(to);
@@ -60,13 +93,43 @@ namespace eosio {
         add_balance(to, quantity);
     }
 
+    ACTION getbit::chargebatch(const name &from, const vector<pair<name, asset>> &transfers,
+                               const string &memo) {
+        require_auth(get_self());
+
+        check(!transfers.empty(), "No transfers to charge");
+        check(memo.size() <= 256, "Memo must be within 256 bytes");
+
+        const auto symbol = transfers.front().second.symbol;
+        check(symbol.is_valid(), "Invalid symbol");
+        check(symbol.precision() == 0, "Precision must be a zero");
+
+        check(_config.has_symbol(symbol.code()), "Symbol does not exist, create before");
+
+        asset total { 0, symbol };
+        for (const auto &[to, quantity] : transfers) {
+            check(from != to, "Cannot transfer to self");
+            check(is_account(to), "To account does not exist");
+
+            check(quantity.is_valid(), "Invalid quantity");
+            check(quantity.amount > 0, "Quantity must be a positive integer");
+            check(quantity.symbol == symbol, "The symbol not the same");
+            total += quantity;
+        }
+
+        require_recipient(from);
+        sub_balance(from, total);
+
+        for (const auto &[to, quantity] : transfers) {
+            require_recipient(to);
+            add_balance(to, quantity);
+        }
+    }
+
     ACTION getbit::open(const name &owner, const symbol &symbol) {
         require_auth(get_self());
 
-        stats      stat_table(get_self(), get_self().value);
-        const auto existing_stat = stat_table.find(symbol.code().raw());
-        check(existing_stat != stat_table.end(),
-              "Symbol does not exist, create before");
+        check(_config.has_symbol(symbol.code()), "Symbol does not exist, create before");
 
         accounts   account_table(get_self(), owner.value);
         const auto existing_account = account_table.find(symbol.code().raw());
@@ -77,22 +140,57 @@ namespace eosio {
         }
     }
 
+    ACTION getbit::setmaxbids(const uint64_t &max_bids) {
+        require_auth(get_self());
+
+        _config.set_max_bids(max_bids);
+    }
+
+    ACTION getbit::setsettle(const uint64_t &refund_bps, const uint64_t &payout_bps) {
+        require_auth(get_self());
+
+        check(refund_bps <= getbit::RATE_BPS_MAX, "Refund rate must be within 10000");
+        check(payout_bps <= getbit::RATE_BPS_MAX, "Payout rate must be within 10000");
+        // Refunds and the payout are parts of the same pot, so they never pay out more than it
+        check(refund_bps + payout_bps <= getbit::RATE_BPS_MAX,
+              "Refund and payout rates must be within 10000 in total");
+
+        _config.set_settle_rates(refund_bps, payout_bps);
+    }
+
     ACTION getbit::biddingstart(const uint64_t &id, const symbol &symbol, const string &type,
-                                const string &prize, const string &public_key) {
+                                const string &prize, const public_key &public_key,
+                                const asset &ticket_price, const time_point &end_time) {
         require_auth(get_self());
 
+        check(end_time > current_time_point(), "End time must be in the future");
+
         check(type == getbit::AUCTION_TYPE_0 || type == getbit::AUCTION_TYPE_1,
               "Unknown auction type");
 
-        stats      stat_table(get_self(), get_self().value);
-        const auto existing_stat = stat_table.find(symbol.code().raw());
-        check(existing_stat != stat_table.end(),
-              "Symbol does not exist, create before");
+        check(id <= UINT32_MAX, "Auction ID must be less than 2^32");
+
+        check(ticket_price.is_valid(), "Invalid ticket price");
+        check(ticket_price.amount > 0, "Ticket price must be a positive integer");
+        check(ticket_price.symbol == symbol, "The symbol not the same");
+
+        check(_config.has_symbol(symbol.code()), "Symbol does not exist, create before");
 
-        auctions   auction_table(get_self(), get_self().value);
+        auctions   auction_table    = auctions_of(id);
         const auto existing_auction = auction_table.find(id);
         check(existing_auction == auction_table.end(),
               "The auction already exists for id");
+
+        archives   archive_table(get_self(), get_self().value);
+        const auto archived_auction = archive_table.find(id);
+        check(archived_auction == archive_table.end(),
+              "The auction already exists for id");
+
+        // Auctions left in the text layout are migrated to the same id later
+        legacy_auctions legacy_auction_table(get_self(), get_self().value);
+        check(legacy_auction_table.find(id) == legacy_auction_table.end(),
+              "The auction already exists for id");
+
         auction_table.emplace(get_self(), [&](auction &a) {
             a.id            = id;
             a.symbol        = symbol;
@@ -103,111 +201,1121 @@ namespace eosio {
             a.prize         = prize;
             a.public_key    = public_key;
             a.winner        = get_self();
-            a.winner_number = "";
-            a.winner_txhash = "";
-            a.private_key   = "";
+            a.winner_number = 0;
+            a.winner_txhash = checksum256();
+            a.private_key   = checksum256();
+            a.total_amount  = asset { 0, symbol };
+            a.bid_count     = 0;
+            a.bidder_count  = 0;
+            a.settled_count = 0;
+            a.ticket_price  = ticket_price;
+            a.end_time      = end_time;
         });
+        add_epoch_auction(id);
     }
 
-    ACTION getbit::bid(const name &bidder, const uint64_t &auction_id,
-                       const asset &quantity, const string &entries, const string &hash) {
+    getbit::bid_receipt getbit::bid(const name &bidder, const uint64_t &auction_id,
+                                    const asset &quantity, const vector<char> &entries,
+                                    const checksum256 &hash) {
         require_auth(bidder);
 
-        check(quantity.is_valid(), "Invalid quantity");
-        check(quantity.amount > 0, "Quantity must be a positive integer");
-        const auto symbol = quantity.symbol;
-        check(symbol.is_valid(), "Invalid symbol");
-        check(symbol.precision() == 0, "Precision must be a zero");
+        return apply_bids(bidder, { bid_entry { auction_id, quantity, entries, hash } }).front();
+    }
 
-        stats      stat_table(get_self(), get_self().value);
-        const auto existing_stat = stat_table.find(symbol.code().raw());
-        check(existing_stat != stat_table.end(),
-              "Symbol does not exist, create before");
+    vector<getbit::bid_receipt> getbit::bidbatch(const name              &bidder,
+                                                 const vector<bid_entry> &items) {
+        require_auth(bidder);
 
-        const asset balance = get_balance(bidder, symbol.code());
-        check(balance.amount >= quantity.amount, "Not enough balance");
+        return apply_bids(bidder, items);
+    }
 
-        auctions   auction_table(get_self(), get_self().value);
-        const auto existing_auction = auction_table.find(auction_id);
+    ACTION getbit::biddingend(const uint64_t &id) {
+        require_auth(get_self());
+
+        auctions     auction_table = auctions_of(id);
+        const string error         = end_bidding(auction_table, id);
+        check(error.empty(), error);
+    }
+
+    vector<getbit::batch_failure> getbit::biddingends(const vector<uint64_t> &ids,
+                                                      const bool          &skip_failures) {
+        require_auth(get_self());
+
+        map<uint64_t, auctions> auction_tables;   // By scope (epoch)
+        vector<batch_failure>   failures;
+        for (const uint64_t id : ids) {
+            const uint64_t scope = id / getbit::AUCTION_EPOCH_SIZE;
+            auto &auction_table
+                = auction_tables.try_emplace(scope, get_self(), scope).first->second;
+            const string error = end_bidding(auction_table, id);
+            if (!error.empty()) {
+                check(skip_failures, error);
+                failures.push_back(batch_failure { id, error });
+            }
+        }
+        return failures;
+    }
+
+    ACTION getbit::calcwinner(const uint64_t &id) {
+        auctions   auction_table    = auctions_of(id);
+        const auto existing_auction = auction_table.find(id);
         check(existing_auction != auction_table.end(),
               "The auction does not exist");
 
-        check(existing_auction->symbol == symbol, "The symbol not the same");
-        check(existing_auction->status == getbit::AUCTION_STATUS_0_BIDDING,
-              "The auction was already ended");
+        check(existing_auction->type == getbit::AUCTION_TYPE_0_TENDER_TEN,
+              "The auction does not compute winner");
+        check(auction_status(*existing_auction) == getbit::AUCTION_STATUS_1_WINNER_CALCULATION,
+              "The auction is not in calculation");
 
-        require_recipient(get_self());
-        require_recipient(bidder);
+        const auto [winner, winner_number] = compute_winner(id);
+        check(winner != get_self(), "No number chosen only once");
 
-        sub_balance(bidder, quantity);
-        add_balance(get_self(), quantity);
+        modify_auction(auction_table, existing_auction, [&](auction &a) {
+            a.status        = getbit::AUCTION_STATUS_1_WINNER_CALCULATION;
+            a.winner        = winner;
+            a.winner_number = winner_number;
+        });
     }
 
-    ACTION getbit::biddingend(const uint64_t &id) {
+    ACTION getbit::selectwinner(const uint64_t &id, const name &winner,
+                                const uint64_t &winner_number, const checksum256 &winner_txhash,
+                                const checksum256 &private_key) {
         require_auth(get_self());
 
-        auctions   auction_table(get_self(), get_self().value);
-        const auto existing_auction = auction_table.find(id);
+        auctions     auction_table = auctions_of(id);
+        const string error         = select_winner(
+            auction_table, winner_entry { id, winner, winner_number, winner_txhash, private_key });
+        check(error.empty(), error);
+    }
+
+    vector<getbit::batch_failure> getbit::selwinners(const vector<winner_entry> &winners,
+                                                     const bool                 &skip_failures) {
+        require_auth(get_self());
+
+        map<uint64_t, auctions> auction_tables;   // By scope (epoch)
+        vector<batch_failure>   failures;
+        for (const auto &entry : winners) {
+            const uint64_t scope = entry.id / getbit::AUCTION_EPOCH_SIZE;
+            auto &auction_table
+                = auction_tables.try_emplace(scope, get_self(), scope).first->second;
+            const string error = select_winner(auction_table, entry);
+            if (!error.empty()) {
+                check(skip_failures, error);
+                failures.push_back(batch_failure { entry.id, error });
+            }
+        }
+        return failures;
+    }
+
+    ACTION getbit::settle(const uint64_t &auction_id, const uint64_t &max_rows) {
+        require_auth(get_self());
+
+        check(max_rows > 0, "Maximum rows must be a positive integer");
+
+        auctions   auction_table    = auctions_of(auction_id);
+        const auto existing_auction = auction_table.find(auction_id);
         check(existing_auction != auction_table.end(),
               "The auction does not exist");
 
-        check(existing_auction->status == getbit::AUCTION_STATUS_0_BIDDING,
-              "The auction was already ended");
+        check(existing_auction->status == getbit::AUCTION_STATUS_2_WINNER_SELECTED,
+              "The winner of the auction is not selected");
 
-        auction_table.modify(existing_auction, get_self(), [&](auction &a) {
-            a.status = getbit::AUCTION_STATUS_1_WINNER_CALCULATION;
+        const uint64_t refund_bps = _config.refund_bps();
+        const name     winner     = existing_auction->winner;
+
+        // Bids are streamed by the byauctseq index (index 1), so each is found by the
+        // database instead of searched for among the rows multi_index keeps loaded
+        uint64_t   settled_count = existing_auction->get_settled_count();
+        bid_stream itr(get_self(), get_self().value, 1,
+                       bidding::auction_key(auction_id, settled_count));
+        for (uint64_t rows = 0; itr && itr->auction_id == auction_id && rows < max_rows;
+             ++itr, ++rows) {
+            const asset refund = rate_of(itr->quantity, refund_bps);
+            if (itr->bidder != winner && refund.amount > 0) {
+                sub_balance(get_self(), refund);
+                add_balance(itr->bidder, refund);
+            }
+            settled_count = itr->sequence + 1;
+        }
+        const bool settled = !itr || itr->auction_id != auction_id;
+
+        // The contract as winner is no winner (no number chosen only once)
+        const asset payout = rate_of(existing_auction->total_amount, _config.payout_bps());
+        if (settled && winner != get_self() && payout.amount > 0) {
+            sub_balance(get_self(), payout);
+            add_balance(winner, payout);
+        }
+
+        modify_auction(auction_table, existing_auction, [&](auction &a) {
+            a.settled_count = settled_count;
+            if (settled) {
+                a.status = getbit::AUCTION_STATUS_3_SETTLED;
+            }
         });
     }
 
-    ACTION getbit::selectwinner(const uint64_t &id, const name &winner,
-                                const string &winner_number, const string &winner_txhash,
-                                const string &private_key) {
+    ACTION getbit::archive(const uint64_t &max_rows) {
         require_auth(get_self());
 
-        auctions   auction_table(get_self(), get_self().value);
+        check(max_rows > 0, "Maximum rows must be a positive integer");
+
+        epochs   epoch_table(get_self(), get_self().value);
+        archives archive_table(get_self(), get_self().value);
+
+        auto     epoch_itr     = epoch_table.begin();
+        uint64_t archived_rows = 0;
+        while (epoch_itr != epoch_table.end() && archived_rows < max_rows) {
+            // Settled auctions are streamed by the bystatustype index (index 0)
+            auction_stream rows(get_self(), epoch_itr->id, 0,
+                                auction::status_type_key(getbit::AUCTION_STATUS_3_SETTLED, 0, 0));
+            uint64_t       epoch_rows = 0;
+            while (rows && rows->status == getbit::AUCTION_STATUS_3_SETTLED
+                   && archived_rows < max_rows) {
+                archive_table.emplace(get_self(), [&](archived &a) {
+                    a.id            = rows->id;
+                    a.symbol        = rows->symbol;
+                    a.type          = rows->type;
+                    a.prize         = rows->prize;
+                    a.winner        = rows->winner;
+                    a.winner_number = rows->winner_number;
+                    a.total_amount  = rows->total_amount;
+                    a.bid_count     = rows->bid_count;
+                    a.bidder_count  = rows->bidder_count;
+                });
+
+                wins       win_table(get_self(), rows->winner.value);
+                const auto existing_win = win_table.find(rows->id);
+                if (existing_win != win_table.end()) {
+                    win_table.modify(existing_win, get_self(), [&](win &w) { w.archived = true; });
+                }
+
+                erase_numbers(rows->id);
+                rows.erase();
+                epoch_rows++;
+                archived_rows++;
+            }
+
+            // The epoch is dropped as a unit when all of its auctions are archived
+            if (epoch_rows == epoch_itr->auction_count) {
+                epoch_itr = epoch_table.erase(epoch_itr);
+            } else {
+                if (epoch_rows > 0) {
+                    epoch_table.modify(epoch_itr, get_self(),
+                                       [&](epoch &e) { e.auction_count -= epoch_rows; });
+                }
+                epoch_itr++;
+            }
+        }
+    }
+
+    vector<getbit::batch_failure> getbit::migrate(const uint64_t &max_rows) {
+        require_auth(get_self());
+
+        check(max_rows > 0, "Maximum rows must be a positive integer");
+
+        legacy_auctions legacy_auction_table(get_self(), get_self().value);
+        archives        archive_table(get_self(), get_self().value);
+        migrations      migration_table(get_self(), get_self().value);
+
+        // Auctions left are skipped, so the cursor moves past them
+        auto itr = legacy_auction_table.lower_bound(
+            migration_table.get_or_default(migration { 0 }).cursor);
+        vector<batch_failure> failures;
+        for (uint64_t rows = 0; itr != legacy_auction_table.end() && rows < max_rows; rows++) {
+            if (itr->id > UINT32_MAX) {
+                failures.push_back(batch_failure { itr->id, "Auction ID must be less than 2^32" });
+                itr++;
+                continue;
+            }
+            auctions auction_table = auctions_of(itr->id);
+            if (auction_table.find(itr->id) != auction_table.end()
+                || archive_table.find(itr->id) != archive_table.end()) {
+                failures.push_back(batch_failure { itr->id, "The auction already exists for id" });
+                itr++;
+                continue;
+            }
+
+            // Auctions with fields not parsed are left as they are, so no text is lost
+            public_key  public_key;
+            uint64_t    winner_number = 0;
+            checksum256 winner_txhash;
+            checksum256 private_key;
+            string      unparsed;
+            const auto  parse = [&](const bool parsed, const char *field) {
+                if (!parsed) {
+                    unparsed += unparsed.empty() ? field : string(", ") + field;
+                }
+            };
+            parse(parse_public_key(itr->public_key, public_key), "public_key");
+            parse(parse_number(itr->winner_number, winner_number), "winner_number");
+            parse(parse_checksum256(itr->winner_txhash, winner_txhash), "winner_txhash");
+            parse(parse_private_key(itr->private_key, private_key), "private_key");
+            if (!unparsed.empty()) {
+                failures.push_back(batch_failure { itr->id, "Fields not parsed: " + unparsed });
+                itr++;
+                continue;
+            }
+
+            const auto migrated = auction_table.emplace(get_self(), [&](auction &a) {
+                a.id            = itr->id;
+                a.symbol        = itr->symbol;
+                a.type          = itr->type;
+                a.status        = itr->status;
+                a.prize         = itr->prize;
+                a.public_key    = public_key;
+                a.winner        = itr->winner;
+                a.winner_number = winner_number;
+                a.winner_txhash = winner_txhash;
+                a.private_key   = private_key;
+                a.total_amount  = itr->total_amount.has_value()
+                                      ? itr->total_amount.value()
+                                      : asset { 0, itr->symbol };
+                a.bid_count     = itr->bid_count.has_value() ? itr->bid_count.value() : 0;
+                a.bidder_count
+                    = itr->bidder_count.has_value() ? itr->bidder_count.value() : 0;
+                a.settled_count = 0;
+                a.ticket_price  = asset { 0, itr->symbol };
+                a.end_time      = time_point(microseconds::maximum());
+            });
+            add_epoch_auction(itr->id);
+            if (migrated->status >= getbit::AUCTION_STATUS_2_WINNER_SELECTED) {
+                add_win(*migrated);
+            }
+
+            itr = legacy_auction_table.erase(itr);
+        }
+
+        if (itr == legacy_auction_table.end()) {
+            if (migration_table.exists()) {
+                migration_table.remove();
+            }
+        } else {
+            migration_table.set(migration { itr->id }, get_self());
+        }
+        return failures;
+    }
+
+#ifdef GETBIT_TEST_ACTIONS
+    ACTION getbit::putlegacy(const vector<legacy_auction_seed> &rows) {
+        require_auth(get_self());
+
+        legacy_auctions legacy_auction_table(get_self(), get_self().value);
+        for (const auto &row : rows) {
+            // Extensions are left empty, so the row is stored in the first layout
+            const auto assign = [&](legacy_auction &a) {
+                a.id            = row.id;
+                a.symbol        = row.symbol;
+                a.type          = row.type;
+                a.status        = row.status;
+                a.prize         = row.prize;
+                a.public_key    = row.public_key;
+                a.winner        = row.winner;
+                a.winner_number = row.winner_number;
+                a.winner_txhash = row.winner_txhash;
+                a.private_key   = row.private_key;
+            };
+            const auto existing_auction = legacy_auction_table.find(row.id);
+            if (existing_auction == legacy_auction_table.end()) {
+                legacy_auction_table.emplace(get_self(), assign);
+            } else {
+                legacy_auction_table.modify(existing_auction, get_self(), assign);
+            }
+        }
+    }
+#endif
+
+    getbit::auction_page getbit::getauctions(const uint64_t &status, const uint64_t &type,
+                                             const uint64_t &cursor, const uint64_t &limit) {
+        check(limit > 0 && limit <= getbit::QUERY_LIMIT_MAX, "Limit must be 1 to 100");
+        check(cursor <= UINT32_MAX, "Cursor must be less than 2^32");
+
+        epochs       epoch_table(get_self(), get_self().value);
+        auction_page page { {}, false, 0 };
+
+        // Bidding past its end time is ended, so it is scanned for ended auctions too
+        const uint64_t bidding_status = status == getbit::AUCTION_STATUS_1_WINNER_CALCULATION
+                                            ? getbit::AUCTION_STATUS_0_BIDDING
+                                            : status;
+
+        // The cursor is below IDs of the epochs after its own
+        auto epoch_itr = epoch_table.lower_bound(cursor / getbit::AUCTION_EPOCH_SIZE);
+        for (; epoch_itr != epoch_table.end(); epoch_itr++) {
+            auctions auction_table(get_self(), epoch_itr->id);
+            auto     status_index = auction_table.get_index<"bystatustype"_n>();
+
+            auto itr = status_index.lower_bound(auction::status_type_key(status, type, cursor));
+            auto last
+                = status_index.upper_bound(auction::status_type_key(status, type, UINT32_MAX));
+            auto bidding_itr = status_index.lower_bound(
+                auction::status_type_key(bidding_status, type, cursor));
+            auto bidding_last = bidding_status == status
+                                    ? bidding_itr
+                                    : status_index.upper_bound(auction::status_type_key(
+                                        bidding_status, type, UINT32_MAX));
+
+            // Both ranges are in ID order, so they are merged by ID
+            const auto skip_other_status = [&](auto &from, const auto &to) {
+                while (from != to && auction_status(*from) != status) {
+                    from++;
+                }
+            };
+            while (true) {
+                skip_other_status(itr, last);
+                skip_other_status(bidding_itr, bidding_last);
+                if (itr == last && bidding_itr == bidding_last) {
+                    break;
+                }
+                auto &next
+                    = bidding_itr == bidding_last || (itr != last && itr->id < bidding_itr->id)
+                          ? itr
+                          : bidding_itr;
+
+                if (page.rows.size() == limit) {
+                    page.more        = true;
+                    page.next_cursor = next->id;
+                    return page;
+                }
+                page.rows.push_back(auction_view { next->id, status, next->type, next->prize,
+                                                   next->winner, next->total_amount,
+                                                   next->bid_count, next->bidder_count,
+                                                   next->get_ticket_price(),
+                                                   next->get_end_time() });
+                next++;
+            }
+        }
+        return page;
+    }
+
+    vector<asset> getbit::getbalances(const vector<name> &owners, const symbol &symbol) {
+        check(owners.size() <= getbit::QUERY_LIMIT_MAX, "Too many owners to query");
+
+        vector<asset> balances;
+        balances.reserve(owners.size());
+        for (const auto &owner : owners) {
+            accounts   account_table(get_self(), owner.value);
+            const auto existing_account = account_table.find(symbol.code().raw());
+            balances.push_back(existing_account != account_table.end()
+                                   ? existing_account->balance
+                                   : asset(0, symbol));
+        }
+        return balances;
+    }
+
+    void getbit::add_balance(const name &owner, const asset &value) {
+        _balances.add(owner, value);
+    }
+
+    void getbit::sub_balance(const name &owner, const asset &value) {
+        _balances.sub(owner, value);
+    }
+
+    vector<getbit::bid_receipt> getbit::apply_bids(const name              &bidder,
+                                                   const vector<bid_entry> &items) {
+        check(!items.empty(), "No bids to apply");
+
+        const auto symbol = items.front().quantity.symbol;
+        check(symbol.is_valid(), "Invalid symbol");
+        check(symbol.precision() == 0, "Precision must be a zero");
+
+        check(_config.has_symbol(symbol.code()), "Symbol does not exist, create before");
+
+        map<uint64_t, auctions> auction_tables;   // By scope (epoch)
+        bids                    bid_table(get_self(), get_self().value);
+
+        // Changes to apply once to each auction bid for
+        struct auction_bids {
+            auctions                *table;
+            auctions::const_iterator auction;
+            asset                    amount;
+            uint64_t                 count;
+            uint64_t                 next_sequence;
+            asset                    pot;   // Pot of the auction as of the bid
+        };
+        map<uint64_t, auction_bids> bid_auctions;
+
+        vector<vector<uint64_t>> item_numbers;   // Numbers chosen by each bid
+        item_numbers.reserve(items.size());
+
+        asset total { 0, symbol };
+        for (const auto &item : items) {
+            check(item.quantity.is_valid(), "Invalid quantity");
+            check(item.quantity.amount > 0, "Quantity must be a positive integer");
+            check(item.quantity.symbol == symbol, "The symbol not the same");
+            total += item.quantity;
+
+            // Check each auction only once
+            auto checked_auction = bid_auctions.find(item.auction_id);
+            if (checked_auction == bid_auctions.end()) {
+                const uint64_t scope = item.auction_id / getbit::AUCTION_EPOCH_SIZE;
+                auto &auction_table
+                    = auction_tables.try_emplace(scope, get_self(), scope).first->second;
+                const auto existing_auction = auction_table.find(item.auction_id);
+                check(existing_auction != auction_table.end(),
+                      "The auction does not exist");
+
+                check(existing_auction->symbol == symbol, "The symbol not the same");
+                check(auction_status(*existing_auction) == getbit::AUCTION_STATUS_0_BIDDING,
+                      "The auction was already ended");
+
+                checked_auction
+                    = bid_auctions
+                          .emplace(item.auction_id,
+                                   auction_bids { &auction_table, existing_auction,
+                                                  asset { 0, symbol }, 0,
+                                                  existing_auction->bid_count,
+                                                  existing_auction->total_amount })
+                          .first;
+            }
+            checked_auction->second.amount += item.quantity;
+            checked_auction->second.count++;
+
+            // Bids are stored verified, so winners are computed from entries committed to
+            assert_sha256(item.entries.data(), item.entries.size(), item.hash);
+            item_numbers.push_back(parse_numbers(item.entries));
+
+            const asset ticket_price = checked_auction->second.auction->get_ticket_price();
+            if (ticket_price.amount > 0) {
+                check(item.quantity == ticket_price * item_numbers.back().size(),
+                      "Quantity must be the ticket price times the entries");
+            }
+        }
+
+        const asset balance = get_balance(bidder, symbol.code());
+        check(balance.amount >= total.amount, "Not enough balance");
+
+        require_recipient(get_self());
+        require_recipient(bidder);
+
+        sub_balance(bidder, total);
+
+        const uint64_t max_bids = _config.max_bids();
+        for (const auto &[auction_id, changes] : bid_auctions) {
+            escrows    escrow_table(get_self(), auction_id);
+            const auto existing_escrow = escrow_table.find(symbol.code().raw());
+            if (existing_escrow == escrow_table.end()) {
+                escrow_table.emplace(get_self(),
+                                     [&](escrow &e) { e.balance = changes.amount; });
+            } else {
+                escrow_table.modify(existing_escrow, get_self(),
+                                    [&](escrow &e) { e.balance += changes.amount; });
+            }
+
+            participations participation_table(get_self(), bidder.value);
+            const auto     existing_participation = participation_table.find(auction_id);
+            const bool     new_bidder = existing_participation == participation_table.end();
+            if (new_bidder) {
+                check(max_bids == 0 || changes.count <= max_bids,
+                      "Too many bids for the auction");
+                participation_table.emplace(get_self(), [&](participation &p) {
+                    p.auction_id   = auction_id;
+                    p.bid_count    = changes.count;
+                    p.total_amount = changes.amount;
+                });
+            } else {
+                check(max_bids == 0
+                          || existing_participation->bid_count + changes.count <= max_bids,
+                      "Too many bids for the auction");
+                participation_table.modify(existing_participation, get_self(),
+                                           [&](participation &p) {
+                                               p.bid_count += changes.count;
+                                               p.total_amount += changes.amount;
+                                           });
+            }
+
+            modify_auction(*changes.table, changes.auction, [&](auction &a) {
+                a.total_amount += changes.amount;
+                a.bid_count += changes.count;
+                if (new_bidder) {
+                    a.bidder_count++;
+                }
+            });
+        }
+
+        asset               remaining = balance;   // Balance as of the bid
+        vector<bid_receipt> receipts;
+        receipts.reserve(items.size());
+
+        map<uint64_t, vector<pair<uint64_t, uint64_t>>> choices;   // Numbers chosen by auction
+        for (size_t i = 0; i < items.size(); i++) {
+            const auto    &item = items[i];
+            const uint64_t id   = bid_table.available_primary_key();
+
+            auto &changes = bid_auctions.at(item.auction_id);
+            if (changes.auction->type == getbit::AUCTION_TYPE_0_TENDER_TEN) {
+                for (const uint64_t number : item_numbers[i]) {
+                    choices[item.auction_id].emplace_back(number, id);
+                }
+            }
+
+            bid_table.emplace(get_self(), [&](bidding &b) {
+                b.id         = id;
+                b.auction_id = item.auction_id;
+                b.sequence   = changes.next_sequence++;
+                b.bidder     = bidder;
+                b.quantity   = item.quantity;
+                b.entries    = item.entries;
+                b.hash       = item.hash;
+            });
+            remaining -= item.quantity;
+            changes.pot += item.quantity;
+            receipts.push_back(bid_receipt { item.auction_id, changes.next_sequence - 1,
+                                             remaining, changes.pot });
+        }
+
+        for (auto &[auction_id, auction_choices] : choices) {
+            count_numbers(auction_id, auction_choices);
+        }
+        return receipts;
+    }
+
+    getbit::auctions getbit::auctions_of(const uint64_t id) {
+        return auctions(get_self(), id / getbit::AUCTION_EPOCH_SIZE);
+    }
+
+    void getbit::add_epoch_auction(const uint64_t id) {
+        epochs     epoch_table(get_self(), get_self().value);
+        const auto existing_epoch = epoch_table.find(id / getbit::AUCTION_EPOCH_SIZE);
+        if (existing_epoch == epoch_table.end()) {
+            epoch_table.emplace(get_self(), [&](epoch &e) {
+                e.id            = id / getbit::AUCTION_EPOCH_SIZE;
+                e.auction_count = 1;
+            });
+        } else {
+            epoch_table.modify(existing_epoch, get_self(), [&](epoch &e) { e.auction_count++; });
+        }
+    }
+
+    bool getbit::clean_auctions(uint64_t &cursor, uint64_t &max_rows) {
+        epochs epoch_table(get_self(), get_self().value);
+        auto   itr = epoch_table.lower_bound(cursor / getbit::AUCTION_EPOCH_SIZE);
+        while (itr != epoch_table.end()) {
+            auction_stream rows(get_self(), itr->id, cursor);
+            while (rows) {
+                // Numbers go first, so none is left once the auction is gone
+                uint64_t bucket_cursor = 0;
+                if (!clean_table<number_stream>(rows->id, bucket_cursor, max_rows,
+                                                [](const number_bucket &) {})
+                    || max_rows == 0) {
+                    cursor = rows->id;
+                    return false;
+                }
+
+                erase_win(rows->winner, rows->id);
+                sweep_escrow(rows->id, rows->symbol);
+                rows.erase();
+                max_rows--;
+            }
+            itr = epoch_table.erase(itr);
+        }
+        return true;
+    }
+
+    uint64_t getbit::count_auctions(const uint64_t cursor, const uint64_t limit) {
+        epochs   epoch_table(get_self(), get_self().value);
+        uint64_t count = 0;
+        for (auto itr = epoch_table.lower_bound(cursor / getbit::AUCTION_EPOCH_SIZE);
+             itr != epoch_table.end() && count < limit; ++itr) {
+            for (auction_stream rows(get_self(), itr->id, cursor); rows && count < limit;
+                 ++rows) {
+                count += count_rows<number_stream>(rows->id, 0, limit - count);
+                count += count < limit ? 1 : 0;
+            }
+        }
+        return count;
+    }
+
+    void getbit::sweep_escrow(const uint64_t auction_id, const symbol &symbol) {
+        escrows    escrow_table(get_self(), auction_id);
+        const auto existing_escrow = escrow_table.find(symbol.code().raw());
+        if (existing_escrow != escrow_table.end()) {
+            add_balance(get_self(), existing_escrow->balance);
+            escrow_table.erase(existing_escrow);
+        }
+    }
+
+    void getbit::refund_escrow(const bidding &b) {
+        escrows    escrow_table(get_self(), b.auction_id);
+        const auto existing_escrow = escrow_table.find(b.quantity.symbol.code().raw());
+        if (existing_escrow == escrow_table.end()) {
+            return;
+        }
+        check(existing_escrow->balance.amount >= b.quantity.amount, "Overdrawn escrow");
+
+        add_balance(b.bidder, b.quantity);
+        if (existing_escrow->balance == b.quantity) {
+            escrow_table.erase(existing_escrow);
+        } else {
+            escrow_table.modify(existing_escrow, get_self(),
+                                [&](escrow &e) { e.balance -= b.quantity; });
+        }
+    }
+
+    void getbit::erase_participation(const name &bidder, const uint64_t auction_id) {
+        participations participation_table(get_self(), bidder.value);
+        const auto     existing_participation = participation_table.find(auction_id);
+        if (existing_participation != participation_table.end()) {
+            participation_table.erase(existing_participation);
+        }
+    }
+
+    void getbit::erase_win(const name &winner, const uint64_t auction_id) {
+        wins       win_table(get_self(), winner.value);
+        const auto existing_win = win_table.find(auction_id);
+        if (existing_win != win_table.end()) {
+            win_table.erase(existing_win);
+        }
+    }
+
+    string getbit::end_bidding(auctions &auction_table, const uint64_t id) {
         const auto existing_auction = auction_table.find(id);
-        check(existing_auction != auction_table.end(),
-              "The auction does not exist");
+        if (existing_auction == auction_table.end()) {
+            return "The auction does not exist";
+        }
 
-        check(existing_auction->status == getbit::AUCTION_STATUS_1_WINNER_CALCULATION,
-              "The auction is not in calculation");
+        if (existing_auction->status != getbit::AUCTION_STATUS_0_BIDDING) {
+            return "The auction was already ended";
+        }
+
+        modify_auction(auction_table, existing_auction, [&](auction &a) {
+            a.status = getbit::AUCTION_STATUS_1_WINNER_CALCULATION;
+        });
+        return "";
+    }
+
+    string getbit::select_winner(auctions &auction_table, const winner_entry &entry) {
+        const auto existing_auction = auction_table.find(entry.id);
+        if (existing_auction == auction_table.end()) {
+            return "The auction does not exist";
+        }
+
+        if (auction_status(*existing_auction) != getbit::AUCTION_STATUS_1_WINNER_CALCULATION) {
+            return "The auction is not in calculation";
+        }
+
+        // The winner of TENDER_TEN is computed here unless computed by calcwinner before
+        if (existing_auction->type == getbit::AUCTION_TYPE_0_TENDER_TEN) {
+            const auto [winner, winner_number]
+                = existing_auction->winner != get_self()
+                      ? make_pair(existing_auction->winner, existing_auction->winner_number)
+                      : compute_winner(entry.id);
+            if (entry.winner != winner || entry.winner_number != winner_number) {
+                return "The winner is not the one computed";
+            }
+        }
+
+        sweep_escrow(entry.id, existing_auction->symbol);
 
-        auction_table.modify(existing_auction, get_self(), [&](auction &a) {
+        modify_auction(auction_table, existing_auction, [&](auction &a) {
             a.status        = getbit::AUCTION_STATUS_2_WINNER_SELECTED;
-            a.winner        = winner;
-            a.winner_number = winner_number;
-            a.winner_txhash = winner_txhash;
-            a.private_key   = private_key;
+            a.winner        = entry.winner;
+            a.winner_number = entry.winner_number;
+            a.winner_txhash = entry.winner_txhash;
+            a.private_key   = entry.private_key;
         });
+
+        add_win(*existing_auction);
+        return "";
     }
 
-    void getbit::add_balance(const name &owner, const asset &value) {
-        accounts   account_table(get_self(), owner.value);
-        const auto to = account_table.find(value.symbol.code().raw());
-        if (to == account_table.end()) {
-            account_table.emplace(get_self(), [&](auto &a) { a.balance = value; });
+    void getbit::add_win(const auction &a) {
+        // The contract as winner is no winner (no number chosen only once)
+        if (a.winner == get_self()) {
+            return;
+        }
+
+        wins win_table(get_self(), a.winner.value);
+        win_table.emplace(get_self(), [&](win &w) {
+            w.auction_id    = a.id;
+            w.type          = a.type;
+            w.prize         = a.prize;
+            w.winner_number = a.winner_number;
+            w.total_amount  = a.total_amount;
+            w.archived      = false;
+        });
+    }
+
+    asset getbit::rate_of(const asset &quantity, const uint64_t bps) const {
+        const int128_t amount = static_cast<int128_t>(quantity.amount) * bps / getbit::RATE_BPS_MAX;
+        return asset { static_cast<int64_t>(amount), quantity.symbol };
+    }
+
+    pair<name, uint64_t> getbit::compute_winner(const uint64_t id) {
+        number_buckets bucket_table(get_self(), id);
+        for (const auto &bucket : bucket_table) {
+            const uint64_t unique = bucket.once & ~bucket.many;
+            if (unique == 0) {
+                continue;
+            }
+
+            const uint64_t bit  = __builtin_ctzll(unique);
+            const uint64_t rank = __builtin_popcountll(bucket.once & ((1ULL << bit) - 1));
+
+            bids        bid_table(get_self(), get_self().value);
+            const auto &winning_bid
+                = bid_table.get(bucket.first_bids[rank], "The bid does not exist");
+            return make_pair(winning_bid.bidder, bucket.id * getbit::NUMBER_BUCKET_SIZE + bit);
+        }
+        return make_pair(get_self(), 0);
+    }
+
+    uint64_t getbit::auction_status(const auction &a) const {
+        if (a.status == getbit::AUCTION_STATUS_0_BIDDING
+            && current_time_point() >= a.get_end_time()) {
+            return getbit::AUCTION_STATUS_1_WINNER_CALCULATION;
+        }
+        return a.status;
+    }
+
+    vector<uint64_t> getbit::parse_numbers(const vector<char> &entries) {
+        datastream<const char *> ds(entries.data(), entries.size());
+
+        uint8_t version = 0;
+        ds >> version;
+        check(version == getbit::ENTRIES_VERSION_1_DELTA_LIST, "Unknown version of entries");
+
+        unsigned_int count;
+        ds >> count;
+        check(count.value > 0, "No number chosen");
+        check(count.value <= getbit::AUCTION_NUMBER_MAX + 1, "Too many numbers chosen");
+
+        // Ascending numbers as differences from the previous (from zero for the first)
+        vector<uint64_t> numbers;
+        numbers.reserve(count.value);
+        for (uint32_t i = 0; i < count.value; i++) {
+            unsigned_int delta;
+            ds >> delta;
+            check(i == 0 || delta.value > 0, "Numbers chosen must be in ascending order");
+
+            const uint64_t number = (i == 0 ? 0 : numbers.back()) + delta.value;
+            check(number <= getbit::AUCTION_NUMBER_MAX, "Number chosen out of range");
+            numbers.push_back(number);
+        }
+        check(ds.remaining() == 0, "Invalid entries");
+        return numbers;
+    }
+
+    void getbit::count_numbers(const uint64_t auction_id,
+                               vector<pair<uint64_t, uint64_t>> &choices) {
+        // Group by bucket, keeping bid order of the same number
+        stable_sort(choices.begin(), choices.end(),
+                    [](const auto &a, const auto &b) { return a.first < b.first; });
+
+        number_buckets bucket_table(get_self(), auction_id);
+
+        auto itr = choices.begin();
+        while (itr != choices.end()) {
+            const uint64_t bucket_id = itr->first / getbit::NUMBER_BUCKET_SIZE;
+
+            number_bucket bucket { bucket_id, 0, 0, {} };
+            const auto    existing_bucket = bucket_table.find(bucket_id);
+            if (existing_bucket != bucket_table.end()) {
+                bucket = *existing_bucket;
+            }
+
+            for (; itr != choices.end() && itr->first / getbit::NUMBER_BUCKET_SIZE == bucket_id;
+                 ++itr) {
+                const uint64_t bit = 1ULL << (itr->first % getbit::NUMBER_BUCKET_SIZE);
+                if (bucket.once & bit) {
+                    bucket.many |= bit;
+                } else {
+                    const uint64_t rank = __builtin_popcountll(bucket.once & (bit - 1));
+                    bucket.first_bids.insert(bucket.first_bids.begin() + rank, itr->second);
+                    bucket.once |= bit;
+                }
+            }
+
+            if (existing_bucket == bucket_table.end()) {
+                bucket_table.emplace(get_self(), [&](number_bucket &b) { b = bucket; });
+            } else {
+                bucket_table.modify(existing_bucket, get_self(),
+                                    [&](number_bucket &b) { b = bucket; });
+            }
+        }
+    }
+
+    void getbit::erase_numbers(const uint64_t auction_id) {
+        for (number_stream rows(get_self(), auction_id, 0); rows;) {
+            rows.erase();
+        }
+    }
+
+    bool getbit::parse_checksum256(const string &hex, checksum256 &value) {
+        value = checksum256();
+        if (hex.empty()) {
+            return true;
+        }
+        if (hex.size() != 64) {
+            return false;
+        }
+
+        const auto hex_value = [](const char c) -> int {
+            if (c >= '0' && c <= '9') {
+                return c - '0';
+            }
+            if (c >= 'a' && c <= 'f') {
+                return c - 'a' + 10;
+            }
+            if (c >= 'A' && c <= 'F') {
+                return c - 'A' + 10;
+            }
+            return -1;
+        };
+
+        array<uint8_t, 32> bytes;
+        for (size_t i = 0; i < bytes.size(); i++) {
+            const int high = hex_value(hex[i * 2]);
+            const int low  = hex_value(hex[i * 2 + 1]);
+            if (high < 0 || low < 0) {
+                return false;
+            }
+            bytes[i] = (high << 4) | low;
+        }
+        value = checksum256(bytes);
+        return true;
+    }
+
+    bool getbit::parse_number(const string &text, uint64_t &value) {
+        value           = 0;
+        uint64_t number = 0;
+        for (const char c : text) {
+            if (c < '0' || c > '9' || number > (UINT64_MAX - (c - '0')) / 10) {
+                return false;
+            }
+            number = number * 10 + (c - '0');
+        }
+        value = number;
+        return true;
+    }
+
+    bool getbit::parse_base58(const string &text, uint8_t *bytes, const size_t size) {
+        static const string alphabet
+            = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+        fill_n(bytes, size, 0);
+        for (const char c : text) {
+            const size_t digit = alphabet.find(c);
+            if (digit == string::npos) {
+                return false;
+            }
+            uint32_t carry = digit;
+            for (size_t i = size; i-- > 0;) {
+                carry += 58 * uint32_t(bytes[i]);
+                bytes[i] = carry & 0xff;
+                carry >>= 8;
+            }
+            if (carry != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool getbit::parse_public_key(const string &text, public_key &value) {
+        value = public_key();
+        if (text.empty()) {
+            return true;
+        }
+
+        // The checksum is ripemd160 of the key, with the key type appended for PUB_K1_
+        string encoded;
+        string suffix;
+        if (text.rfind("PUB_K1_", 0) == 0) {
+            encoded = text.substr(7);
+            suffix  = "K1";
+        } else if (text.rfind("EOS", 0) == 0) {
+            encoded = text.substr(3);
         } else {
-            account_table.modify(to, get_self(),
-                                 [&](auto &a) { a.balance += value; });
+            return false;
         }
+
+        // The 33 bytes of the key and 4 bytes of the checksum
+        array<uint8_t, 37> bytes;
+        if (!parse_base58(encoded, bytes.data(), bytes.size())) {
+            return false;
+        }
+
+        ecc_public_key key;
+        copy_n(bytes.begin(), key.size(), key.begin());
+        string checked(key.begin(), key.end());
+        checked += suffix;
+        const auto checksum = ripemd160(checked.data(), checked.size()).extract_as_byte_array();
+        if (!equal(checksum.begin(), checksum.begin() + 4, bytes.begin() + key.size())) {
+            return false;
+        }
+        value = public_key(in_place_index<0>, key);
+        return true;
     }
 
-    void getbit::sub_balance(const name &owner, const asset &value) {
-        accounts account_table(get_self(), owner.value);
+    bool getbit::parse_private_key(const string &text, checksum256 &value) {
+        value = checksum256();
+        if (text.empty()) {
+            return true;
+        }
+        if (text.size() == 64) {
+            return parse_checksum256(text, value);
+        }
 
-        const auto &from
-            = account_table.get(value.symbol.code().raw(), "Balance not found");
-        check(from.balance.amount >= value.amount, "Overdrawn balance");
+        array<uint8_t, 32> key;
+        if (text.rfind("PVT_K1_", 0) == 0) {
+            // The 32 bytes of the key and 4 bytes of ripemd160 of the key with "K1" appended
+            array<uint8_t, 36> bytes;
+            if (!parse_base58(text.substr(7), bytes.data(), bytes.size())) {
+                return false;
+            }
+            copy_n(bytes.begin(), key.size(), key.begin());
 
-        account_table.modify(from, get_self(),
-                             [&](auto &a) { a.balance -= value; });
+            string checked(key.begin(), key.end());
+            checked += "K1";
+            const auto checksum
+                = ripemd160(checked.data(), checked.size()).extract_as_byte_array();
+            if (!equal(checksum.begin(), checksum.begin() + 4, bytes.begin() + key.size())) {
+                return false;
+            }
+        } else {
+            // WIF: version 0x80, the 32 bytes of the key and 4 bytes of sha256 twice
+            array<uint8_t, 37> bytes;
+            if (!parse_base58(text, bytes.data(), bytes.size()) || bytes[0] != 0x80) {
+                return false;
+            }
+            copy_n(bytes.begin() + 1, key.size(), key.begin());
+
+            const auto once = sha256(reinterpret_cast<const char *>(bytes.data()), 1 + key.size())
+                                  .extract_as_byte_array();
+            const auto checksum
+                = sha256(reinterpret_cast<const char *>(once.data()), once.size())
+                      .extract_as_byte_array();
+            if (!equal(checksum.begin(), checksum.begin() + 4, bytes.begin() + 1 + key.size())) {
+                return false;
+            }
+        }
+        value = checksum256(key);
+        return true;
     }
 
     asset getbit::get_balance(const name &owner, const symbol_code &symbol_code) {
-        accounts account_table(get_self(), owner.value);
+        return _balances.get(owner, symbol_code);
+    }
+
+    asset getbit::balance_cache::get(const name &owner, const symbol_code &symbol_code) {
+        const auto &cached = load(owner, symbol_code);
+        check(cached.opened, "Balance account not opened");
+        return cached.balance;
+    }
+
+    void getbit::balance_cache::add(const name &owner, const asset &value) {
+        auto &cached = load(owner, value.symbol.code());
+        if (cached.opened) {
+            cached.balance += value;
+        } else {
+            cached.balance = value;
+            cached.opened  = true;
+        }
+        cached.dirty = true;
+    }
+
+    void getbit::balance_cache::sub(const name &owner, const asset &value) {
+        auto &cached = load(owner, value.symbol.code());
+        check(cached.opened, "Balance not found");
+        check(cached.balance.amount >= value.amount, "Overdrawn balance");
+
+        cached.balance -= value;
+        cached.dirty = true;
+    }
+
+    void getbit::balance_cache::flush() {
+        for (auto &[key, cached] : _entries) {
+            if (!cached.dirty) {
+                continue;
+            }
+
+            // The row loaded is kept by the table, so no lookup is repeated here
+            const auto existing_account = cached.table.find(cached.balance.symbol.code().raw());
+            if (existing_account == cached.table.end()) {
+                cached.table.emplace(_code, [&](account &a) { a.balance = cached.balance; });
+            } else {
+                cached.table.modify(existing_account, _code,
+                                    [&](account &a) { a.balance = cached.balance; });
+            }
+            cached.dirty = false;
+        }
+    }
+
+    getbit::balance_cache::entry &getbit::balance_cache::load(const name        &owner,
+                                                              const symbol_code &symbol_code) {
+        const auto [itr, inserted] = _entries.try_emplace(
+            make_pair(owner.value, symbol_code.raw()), _code, owner);
+        auto &cached = itr->second;
+        if (inserted) {
+            const auto existing_account = cached.table.find(symbol_code.raw());
+            if (existing_account != cached.table.end()) {
+                cached.balance = existing_account->balance;
+                cached.opened  = true;
+            }
+        }
+        return cached;
+    }
+
+    bool getbit::config_cache::has_symbol(const symbol_code &symbol_code) {
+        const auto &symbols = load().symbols;
+        return find(symbols.begin(), symbols.end(), symbol_code) != symbols.end();
+    }
+
+    void getbit::config_cache::add_symbol(const symbol_code &symbol_code) {
+        load().symbols.push_back(symbol_code);
+        _dirty = true;
+    }
+
+    uint64_t getbit::config_cache::max_bids() {
+        const auto &max_bids = load().max_bids;
+        return max_bids.has_value() ? max_bids.value() : 0;
+    }
+
+    void getbit::config_cache::set_max_bids(const uint64_t max_bids) {
+        load().max_bids = max_bids;
+        _dirty          = true;
+    }
 
-        const auto &owner_account = account_table.get(
-            symbol_code.raw(), "Balance account not opened");
-        return owner_account.balance;
+    uint64_t getbit::config_cache::refund_bps() {
+        const auto &refund_bps = load().refund_bps;
+        return refund_bps.has_value() ? refund_bps.value() : 0;
+    }
+
+    uint64_t getbit::config_cache::payout_bps() {
+        const auto &payout_bps = load().payout_bps;
+        return payout_bps.has_value() ? payout_bps.value() : 0;
+    }
+
+    void getbit::config_cache::set_settle_rates(const uint64_t refund_bps,
+                                                const uint64_t payout_bps) {
+        const uint64_t max_bids = this->max_bids();
+        auto          &loaded   = load();
+        // Extensions before these are written too, so none is skipped when packed
+        loaded.max_bids   = max_bids;
+        loaded.refund_bps = refund_bps;
+        loaded.payout_bps = payout_bps;
+        _dirty            = true;
+    }
+
+    void getbit::config_cache::flush() {
+        if (_dirty) {
+            _table.set(_config, _code);
+            _dirty = false;
+        }
+    }
+
+    getbit::config &getbit::config_cache::load() {
+        if (!_loaded) {
+            if (_table.exists()) {
+                _config = _table.get();
+            } else {
+                // Symbols registered before the config are taken from the stat table once
+                stats stat_table(_code, _code.value);
+                for (const auto &s : stat_table) {
+                    _config.symbols.push_back(s.max_supply.symbol.code());
+                }
+                _dirty = true;
+            }
+            _loaded = true;
+        }
+        return _config;
     }
 }   // namespace eosio
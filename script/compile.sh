@@ -8,7 +8,7 @@ cd $CONTRACT_NAME
 rm -rf build && mkdir build
 cd build
 
-cmake ..
+cmake .. "$@"
 (( $? != 0 )) && echo "CMake build failed" && exit 1
 
 make
@@ -1,11 +1,25 @@
+import { createHash } from "crypto";
 import { Account } from "../library/account";
+import { Serialize } from "eosjs";
 import { Blockchain } from "../library/blockchain";
+import { OTHER_PRIVATE_KEY, OTHER_PUBLIC_KEY } from "../library/constant";
 import {
     AccountRow,
+    ArchiveRow,
+    AuctionPage,
     AuctionRow,
     AuctionStatus,
     AuctionType,
+    BidReceipt,
+    BidRow,
+    ConfigRow,
+    EpochRow,
+    EscrowRow,
+    ParticipationRow,
     StatRow,
+    LegacyAuctionRow,
+    NumberBucketRow,
+    WinRow,
 } from "./libs";
 
 describe("getbit", () => {
@@ -18,6 +32,36 @@ describe("getbit", () => {
     const maxSupply = "4611686018427387903"; // EOSIO Supply 최대 발행량
     const symbol = "GB";
 
+    const ticketPrice = 50;
+    // Auctions are scoped by epoch (ID divided by the epoch size)
+    const auctionEpochSize = 1000;
+    const auctionScope = (id: number) =>
+        Math.floor(id / auctionEpochSize).toString();
+    // Entries of version 1: count and ascending numbers as deltas, in varint
+    const encodeEntries = (numbers: number[]): string => {
+        const bytes: number[] = [1];
+        const pushVarint = (value: number) => {
+            while (value >= 0x80) {
+                bytes.push((value & 0x7f) | 0x80);
+                value >>>= 7;
+            }
+            bytes.push(value);
+        };
+        pushVarint(numbers.length);
+        numbers.forEach((number, index) =>
+            pushVarint(index === 0 ? number : number - numbers[index - 1])
+        );
+        return Buffer.from(bytes).toString("hex");
+    };
+    const hashEntries = (entries: string) =>
+        createHash("sha256").update(Buffer.from(entries, "hex")).digest("hex");
+    // Name as a big-endian hex number (low 64 bits of composite keys)
+    const nameKey = (account: string) => {
+        const buffer = new Serialize.SerialBuffer();
+        buffer.pushName(account);
+        return Buffer.from(buffer.asUint8Array()).reverse().toString("hex");
+    };
+
     const chargeTest: number[] = [1000, 10000, 100000];
     const auctionTest: AuctionRow[] = [
         {
@@ -26,11 +70,19 @@ describe("getbit", () => {
             type: AuctionType.TENDER_TEN,
             status: AuctionStatus.BIDDING,
             prize: "100 USDT",
-            public_key: "publickey",
-            private_key: "privatekey",
+            public_key: OTHER_PUBLIC_KEY,
+            private_key: "b2".repeat(32),
             winner: testAccounts[0],
-            winner_number: "1234",
-            winner_txhash: "txhash",
+            winner_number: 1234,
+            winner_txhash: "c3".repeat(32),
+            total_amount: `0 ${symbol}`,
+            bid_count: 0,
+            bidder_count: 0,
+            settled_count: 0,
+            ticket_price: `${ticketPrice} ${symbol}`,
+            end_time: new Date(Date.now() + 60 * 60 * 1000)
+                .toISOString()
+                .slice(0, -1),
         },
         {
             id: 1,
@@ -38,50 +90,59 @@ describe("getbit", () => {
             type: AuctionType.MEGA_TENDER,
             status: AuctionStatus.BIDDING,
             prize: "100000 USDT",
-            public_key: "publickey",
-            private_key: "privatekey",
+            public_key: OTHER_PUBLIC_KEY,
+            private_key: "b2".repeat(32),
             winner: testAccounts[1],
-            winner_number: "5678",
-            winner_txhash: "txhash",
+            winner_number: 5678,
+            winner_txhash: "c3".repeat(32),
+            total_amount: `0 ${symbol}`,
+            bid_count: 0,
+            bidder_count: 0,
+            settled_count: 0,
+            ticket_price: `${ticketPrice} ${symbol}`,
+            end_time: new Date(Date.now() + 60 * 60 * 1000)
+                .toISOString()
+                .slice(0, -1),
         },
     ];
     const bidTest = [
         {
             bidder: testAccounts[0],
             auction_id: auctionTest[0].id,
-            amount: 100,
-            entries: "entries",
-            hash: "hash",
+            amount: ticketPrice * [1234].length,
+            entries: encodeEntries([1234]),
+            hash: hashEntries(encodeEntries([1234])),
         },
         {
             bidder: testAccounts[0],
             auction_id: auctionTest[1].id,
-            amount: 100,
-            entries: "entries",
-            hash: "hash",
+            amount: ticketPrice * [1234].length,
+            entries: encodeEntries([1234]),
+            hash: hashEntries(encodeEntries([1234])),
         },
         {
             bidder: testAccounts[1],
             auction_id: auctionTest[0].id,
-            amount: 100,
-            entries: "entries",
-            hash: "hash",
+            amount: ticketPrice * [2000, 3000].length,
+            entries: encodeEntries([2000, 3000]),
+            hash: hashEntries(encodeEntries([2000, 3000])),
         },
         {
             bidder: testAccounts[1],
             auction_id: auctionTest[1].id,
-            amount: 100,
-            entries: "entries",
-            hash: "hash",
+            amount: ticketPrice * [5678].length,
+            entries: encodeEntries([5678]),
+            hash: hashEntries(encodeEntries([5678])),
         },
         {
             bidder: testAccounts[2],
             auction_id: auctionTest[0].id,
-            amount: 100,
-            entries: "entries",
-            hash: "hash",
+            amount: ticketPrice * [2000].length,
+            entries: encodeEntries([2000]),
+            hash: hashEntries(encodeEntries([2000])),
         },
     ];
+    const batchBidsPerAuction = 2; // Bids of each auction in the batch
 
     beforeEach(async () => {
         blockchain = new Blockchain({
@@ -190,6 +251,10 @@ describe("getbit", () => {
             expect(findRow).toBeDefined();
             expect(findRow?.max_supply).toEqual(`${maxSupply} ${symbol}`);
 
+            const configResult: ConfigRow[] = await contract.tables.config();
+            expect(configResult.length).toEqual(1);
+            expect(configResult[0].symbols).toContain(symbol);
+
             const accountTableRows: AccountRow[] =
                 await contract.tables.account({
                     scope: contractAccount,
@@ -272,14 +337,60 @@ describe("getbit", () => {
                 expect(nextBalance - beforeBalance).toEqual(chargeTest[index]);
             });
         });
+
+        it(`should charge coupons in batch from {${contractAccount}} to ${testAccounts}`, async () => {
+            const amount = 10;
+            const beforeBalances = await Promise.all(
+                testAccounts.map(async (account) => {
+                    const accountResult: AccountRow[] =
+                        await contract.tables.account({
+                            scope: account,
+                        });
+                    return +accountResult[0].balance.split(" ")[0];
+                })
+            );
+
+            try {
+                const actionResult = await contract.actions.chargebatch(
+                    {
+                        from: contractAccount,
+                        transfers: testAccounts.map((account) => ({
+                            first: account,
+                            second: `${amount} ${symbol}`,
+                        })),
+                        memo: "charge batch test",
+                    },
+                    [
+                        {
+                            actor: contractAccount,
+                            permission: "active",
+                        },
+                    ]
+                );
+                expect(actionResult).toHaveProperty("transaction_id");
+            } catch (error) {
+                throw error;
+            }
+
+            await Promise.all(
+                testAccounts.map(async (account, index) => {
+                    const accountResult: AccountRow[] =
+                        await contract.tables.account({
+                            scope: account,
+                        });
+                    const nextBalance = +accountResult[0].balance.split(" ")[0];
+                    expect(nextBalance - beforeBalances[index]).toEqual(amount);
+                })
+            );
+        });
     });
 
     describe("auction", () => {
         auctionTest.forEach((auction, index) => {
             it(`should start auction #${index}`, async () => {
-                const beforeTable: AuctionRow[] = await contract.tables.auction(
+                const beforeTable: AuctionRow[] = await contract.tables.auctionv2(
                     {
-                        scope: contractAccount,
+                        scope: auctionScope(auction.id),
                     }
                 );
 
@@ -291,6 +402,8 @@ describe("getbit", () => {
                             type: auction.type,
                             prize: auction.prize,
                             public_key: auction.public_key,
+                            ticket_price: auction.ticket_price,
+                            end_time: auction.end_time,
                         },
                         [
                             {
@@ -304,13 +417,21 @@ describe("getbit", () => {
                     throw error;
                 }
 
-                const afterTable: AuctionRow[] = await contract.tables.auction({
-                    scope: contractAccount,
+                const afterTable: AuctionRow[] = await contract.tables.auctionv2({
+                    scope: auctionScope(auction.id),
                 });
                 expect(beforeTable.length + 1).toEqual(afterTable.length);
 
-                const auctions: AuctionRow[] = await contract.tables.auction({
+                const epochs: EpochRow[] = await contract.tables.epoch({
                     scope: contractAccount,
+                    lower_bound: auctionScope(auction.id),
+                    upper_bound: auctionScope(auction.id),
+                });
+                expect(epochs.length).toEqual(1);
+                expect(epochs[0].auction_count).toEqual(afterTable.length);
+
+                const auctions: AuctionRow[] = await contract.tables.auctionv2({
+                    scope: auctionScope(auction.id),
                     index_position: 1,
                     key_type: "i64",
                     lower_bound: auction.id.toString(),
@@ -326,8 +447,14 @@ describe("getbit", () => {
                 expect(auctions[0].prize).toEqual(auction.prize);
                 expect(auctions[0].public_key).toEqual(auction.public_key);
                 expect(auctions[0].winner).toEqual(contractAccount);
-                expect(auctions[0].winner_number).toEqual("");
-                expect(auctions[0].winner_txhash).toEqual("");
+                expect(auctions[0].winner_number).toEqual(0);
+                expect(auctions[0].winner_txhash).toEqual("00".repeat(32));
+                expect(auctions[0].total_amount).toEqual(auction.total_amount);
+                expect(auctions[0].bid_count).toEqual(auction.bid_count);
+                expect(auctions[0].bidder_count).toEqual(auction.bidder_count);
+                expect(auctions[0].settled_count).toEqual(auction.settled_count);
+                expect(auctions[0].ticket_price).toEqual(auction.ticket_price);
+                expect(auctions[0].end_time).toEqual(auction.end_time);
             });
         });
 
@@ -339,8 +466,8 @@ describe("getbit", () => {
                             bidder: bidding.bidder,
                             auction_id: bidding.auction_id,
                             quantity: `${bidding.amount} ${symbol}`,
-                            entries: "entries",
-                            hash: "hash",
+                            entries: bidding.entries,
+                            hash: bidding.hash,
                         },
                         [
                             {
@@ -350,17 +477,302 @@ describe("getbit", () => {
                         ]
                     );
                     expect(actionResult).toHaveProperty("transaction_id");
+
+                    const previousBids = bidTest
+                        .slice(0, index)
+                        .filter((previous) => previous.auction_id === bidding.auction_id);
+                    const receipt: BidReceipt =
+                        actionResult.processed.action_traces[0].return_value_data;
+                    expect(receipt.sequence).toEqual(previousBids.length);
+                    expect(receipt.pot).toEqual(
+                        `${previousBids.reduce(
+                            (sum, previous) => sum + previous.amount,
+                            bidding.amount
+                        )} ${symbol}`
+                    );
+
+                    const accountResult: AccountRow[] = await contract.tables.account({
+                        scope: bidding.bidder,
+                    });
+                    expect(receipt.balance).toEqual(accountResult[0].balance);
                 } catch (error) {
                     throw error;
                 }
             });
         });
 
+        it(`should bid in batch for ${auctionTest.length} auctions by bidder {${testAccounts[2]}}`, async () => {
+            const bidder = testAccounts[2];
+            const amount = ticketPrice;
+            const items = Array.from(
+                { length: auctionTest.length * batchBidsPerAuction },
+                (_, index) => ({
+                    auction_id: auctionTest[Math.floor(index / batchBidsPerAuction)].id,
+                    quantity: `${amount} ${symbol}`,
+                    entries: encodeEntries([3000]),
+                    hash: hashEntries(encodeEntries([3000])),
+                })
+            );
+
+            const beforeAccountResult: AccountRow[] =
+                await contract.tables.account({
+                    scope: bidder,
+                });
+            const beforeBalance = +beforeAccountResult[0].balance.split(" ")[0];
+            const beforeAuctions: AuctionRow[] = await Promise.all(
+                auctionTest.map(
+                    async (auction) =>
+                        (
+                            await contract.tables.auctionv2({
+                                scope: auctionScope(auction.id),
+                                lower_bound: auction.id.toString(),
+                                upper_bound: auction.id.toString(),
+                            })
+                        )[0]
+                )
+            );
+
+            let receipts: BidReceipt[] = [];
+            try {
+                const actionResult: any = await contract.actions.bidbatch(
+                    {
+                        bidder,
+                        items,
+                    },
+                    [
+                        {
+                            actor: bidder,
+                            permission: "active",
+                        },
+                    ]
+                );
+                expect(actionResult).toHaveProperty("transaction_id");
+                receipts = actionResult.processed.action_traces[0].return_value_data;
+            } catch (error) {
+                throw error;
+            }
+
+            const nextAccountResult: AccountRow[] =
+                await contract.tables.account({
+                    scope: bidder,
+                });
+            const nextBalance = +nextAccountResult[0].balance.split(" ")[0];
+
+            expect(beforeBalance - nextBalance).toEqual(amount * items.length);
+
+            // Sequence and pot run on within each auction, and balance over the batch
+            expect(receipts.length).toEqual(items.length);
+            receipts.forEach((receipt, index) => {
+                const item = items[index];
+                const before = beforeAuctions.find(
+                    (auction) => auction.id === item.auction_id
+                ) as AuctionRow;
+                const previousItems = items
+                    .slice(0, index)
+                    .filter((previous) => previous.auction_id === item.auction_id);
+
+                expect(receipt.auction_id).toEqual(item.auction_id);
+                expect(receipt.sequence).toEqual(
+                    before.bid_count + previousItems.length
+                );
+                expect(receipt.pot).toEqual(
+                    `${
+                        +before.total_amount.split(" ")[0] +
+                        amount * (previousItems.length + 1)
+                    } ${symbol}`
+                );
+                expect(receipt.balance).toEqual(
+                    `${beforeBalance - amount * (index + 1)} ${symbol}`
+                );
+            });
+        });
+
+        auctionTest.forEach((auction, index) => {
+            it(`should record bids of auction #${index} in sequence`, async () => {
+                const auctionKey = auction.id.toString(16);
+                const bids: BidRow[] = await contract.tables.bid({
+                    scope: contractAccount,
+                    index_position: 3,
+                    key_type: "i128",
+                    lower_bound: `0x${auctionKey}0000000000000000`,
+                    upper_bound: `0x${auctionKey}ffffffffffffffff`,
+                    limit: 100,
+                });
+
+                const expectedBids =
+                    bidTest.filter((bidding) => bidding.auction_id === auction.id)
+                        .length + batchBidsPerAuction; // with batch bids
+                expect(bids.length).toEqual(expectedBids);
+                bids.forEach((bidding, sequence) => {
+                    expect(bidding.auction_id).toEqual(auction.id);
+                    expect(bidding.sequence).toEqual(sequence);
+                });
+            });
+        });
+
+        testAccounts.forEach((account) => {
+            it(`should find bids of {${account}} by auction`, async () => {
+                for (const auction of auctionTest) {
+                    const auctionBidderKey = `0x${auction.id.toString(16)}${nameKey(account)}`;
+                    const bids: BidRow[] = await contract.tables.bid({
+                        scope: contractAccount,
+                        index_position: 2,
+                        key_type: "i128",
+                        lower_bound: auctionBidderKey,
+                        upper_bound: auctionBidderKey,
+                        limit: 100,
+                    });
+
+                    const batchBids =
+                        account === testAccounts[2] ? batchBidsPerAuction : 0;
+                    expect(bids.length).toEqual(
+                        bidTest.filter(
+                            (bidding) =>
+                                bidding.bidder === account &&
+                                bidding.auction_id === auction.id
+                        ).length + batchBids
+                    );
+                    bids.forEach((bidding) => {
+                        expect(bidding.auction_id).toEqual(auction.id);
+                        expect(bidding.bidder).toEqual(account);
+                    });
+                }
+            });
+        });
+
+        testAccounts.forEach((account) => {
+            it(`should record auctions joined by {${account}}`, async () => {
+                const participations: ParticipationRow[] =
+                    await contract.tables.joined({
+                        scope: account,
+                        limit: 100,
+                    });
+
+                auctionTest.forEach((auction) => {
+                    const bids = bidTest.filter(
+                        (bidding) =>
+                            bidding.bidder === account &&
+                            bidding.auction_id === auction.id
+                    );
+                    const batchBids =
+                        account === testAccounts[2] ? batchBidsPerAuction : 0;
+                    const participation = participations.find(
+                        (row) => row.auction_id === auction.id
+                    );
+                    expect(participation?.bid_count).toEqual(
+                        bids.length + batchBids
+                    );
+                    expect(participation?.total_amount).toEqual(
+                        `${bids.reduce(
+                            (sum, bidding) => sum + bidding.amount,
+                            ticketPrice * batchBids
+                        )} ${symbol}`
+                    );
+                });
+            });
+        });
+
+        it("should not bid more than the maximum bids per bidder", async () => {
+            const bidding = bidTest[0];
+            const setMaxBids = (maxBids: number) =>
+                contract.actions.setmaxbids(
+                    {
+                        max_bids: maxBids,
+                    },
+                    [
+                        {
+                            actor: contractAccount,
+                            permission: "active",
+                        },
+                    ]
+                );
+
+            await setMaxBids(1);
+            await expect(async () => {
+                await contract.actions.bid(
+                    {
+                        bidder: bidding.bidder,
+                        auction_id: bidding.auction_id,
+                        quantity: `${bidding.amount} ${symbol}`,
+                        entries: bidding.entries,
+                        hash: bidding.hash,
+                    },
+                    [
+                        {
+                            actor: bidding.bidder,
+                            permission: "active",
+                        },
+                    ]
+                );
+            }).rejects.toThrowError(
+                "assertion failure with message: Too many bids for the auction"
+            );
+            await setMaxBids(0);
+        });
+
+        auctionTest.forEach((auction, index) => {
+            it(`should aggregate bids of auction #${index}`, async () => {
+                const auctions: AuctionRow[] = await contract.tables.auctionv2({
+                    scope: auctionScope(auction.id),
+                    index_position: 1,
+                    key_type: "i64",
+                    lower_bound: auction.id.toString(),
+                    upper_bound: auction.id.toString(),
+                });
+                expect(auctions.length).toEqual(1);
+
+                const bids: BidRow[] = (
+                    await contract.tables.bid({
+                        scope: contractAccount,
+                        limit: 100,
+                    })
+                ).filter((bidding: BidRow) => bidding.auction_id === auction.id);
+                const totalAmount = bids.reduce(
+                    (sum, bidding) => sum + +bidding.quantity.split(" ")[0],
+                    0
+                );
+                const bidders = new Set(bids.map((bidding) => bidding.bidder));
+
+                expect(auctions[0].total_amount).toEqual(
+                    `${totalAmount} ${symbol}`
+                );
+                expect(auctions[0].bid_count).toEqual(bids.length);
+                expect(auctions[0].bidder_count).toEqual(bidders.size);
+
+                const escrows: EscrowRow[] = await contract.tables.escrow({
+                    scope: auction.id.toString(),
+                });
+                expect(escrows.length).toEqual(1);
+                expect(escrows[0].balance).toEqual(auctions[0].total_amount);
+            });
+        });
+
+        it("should not bid with a hash not matching the entries", async () => {
+            const bidding = bidTest[0];
+            await expect(async () => {
+                await contract.actions.bid(
+                    {
+                        bidder: bidding.bidder,
+                        auction_id: bidding.auction_id,
+                        quantity: `${bidding.amount} ${symbol}`,
+                        entries: bidding.entries,
+                        hash: hashEntries(encodeEntries([4321])),
+                    },
+                    [
+                        {
+                            actor: bidding.bidder,
+                            permission: "active",
+                        },
+                    ]
+                );
+            }).rejects.toThrowError("hash mismatch");
+        });
+
         auctionTest.forEach((auction, index) => {
             it(`should end auction #${index}`, async () => {
                 const beforeAuctions: AuctionRow[] =
-                    await contract.tables.auction({
-                        scope: contractAccount,
+                    await contract.tables.auctionv2({
+                        scope: auctionScope(auction.id),
                         index_position: 1,
                         key_type: "i64",
                         lower_bound: auction.id.toString(),
@@ -389,8 +801,8 @@ describe("getbit", () => {
                 }
 
                 const afterAuctions: AuctionRow[] =
-                    await contract.tables.auction({
-                        scope: contractAccount,
+                    await contract.tables.auctionv2({
+                        scope: auctionScope(auction.id),
                         index_position: 1,
                         key_type: "i64",
                         lower_bound: auction.id.toString(),
@@ -413,8 +825,8 @@ describe("getbit", () => {
                             bidder: bidding.bidder,
                             auction_id: bidding.auction_id,
                             quantity: `${bidding.amount} ${symbol}`,
-                            entries: "entries",
-                            hash: "hash",
+                            entries: bidding.entries,
+                            hash: bidding.hash,
                         },
                         [
                             {
@@ -429,10 +841,111 @@ describe("getbit", () => {
             });
         });
 
+        it("should end auctions at once skipping failures", async () => {
+            const ids = auctionTest.map((auction) => auction.id);
+            await expect(async () => {
+                await contract.actions.biddingends(
+                    {
+                        ids,
+                        skip_failures: false,
+                    },
+                    [
+                        {
+                            actor: contractAccount,
+                            permission: "active",
+                        },
+                    ]
+                );
+            }).rejects.toThrowError(
+                "assertion failure with message: The auction was already ended"
+            );
+
+            try {
+                const actionResult = await contract.actions.biddingends(
+                    {
+                        ids,
+                        skip_failures: true,
+                    },
+                    [
+                        {
+                            actor: contractAccount,
+                            permission: "active",
+                        },
+                    ]
+                );
+                expect(actionResult).toHaveProperty("transaction_id");
+            } catch (error) {
+                throw error;
+            }
+        });
+
+        auctionTest
+            .filter((auction) => auction.type === AuctionType.TENDER_TEN)
+            .forEach((auction) => {
+                it(`should not select a winner not computed for auction #${auction.id}`, async () => {
+                    await expect(async () => {
+                        await contract.actions.selectwinner(
+                            {
+                                id: auction.id,
+                                winner: testAccounts[1],
+                                winner_number: 2000,
+                                winner_txhash: auction.winner_txhash,
+                                private_key: auction.private_key,
+                            },
+                            [
+                                {
+                                    actor: contractAccount,
+                                    permission: "active",
+                                },
+                            ]
+                        );
+                    }).rejects.toThrowError(
+                        "assertion failure with message: The winner is not the one computed"
+                    );
+                });
+            });
+
+        auctionTest
+            .filter((auction) => auction.type === AuctionType.TENDER_TEN)
+            .forEach((auction) => {
+                it(`should compute winner of auction #${auction.id}`, async () => {
+                    try {
+                        const actionResult = await contract.actions.calcwinner(
+                            {
+                                id: auction.id,
+                            },
+                            [
+                                {
+                                    actor: contractAccount,
+                                    permission: "active",
+                                },
+                            ]
+                        );
+                        expect(actionResult).toHaveProperty("transaction_id");
+                    } catch (error) {
+                        throw error;
+                    }
+
+                    const auctions: AuctionRow[] =
+                        await contract.tables.auctionv2({
+                            scope: auctionScope(auction.id),
+                            index_position: 1,
+                            key_type: "i64",
+                            lower_bound: auction.id.toString(),
+                            upper_bound: auction.id.toString(),
+                        });
+                    expect(auctions.length).toEqual(1);
+                    expect(auctions[0].winner).toEqual(auction.winner);
+                    expect(auctions[0].winner_number).toEqual(
+                        auction.winner_number
+                    );
+                });
+            });
+
         auctionTest.forEach((auction, index) => {
             it(`should select winner of auction #${index}`, async () => {
-                const auctions: AuctionRow[] = await contract.tables.auction({
-                    scope: contractAccount,
+                const auctions: AuctionRow[] = await contract.tables.auctionv2({
+                    scope: auctionScope(auction.id),
                     index_position: 1,
                     key_type: "i64",
                     lower_bound: auction.id.toString(),
@@ -467,8 +980,8 @@ describe("getbit", () => {
                 }
 
                 const afterAuctions: AuctionRow[] =
-                    await contract.tables.auction({
-                        scope: contractAccount,
+                    await contract.tables.auctionv2({
+                        scope: auctionScope(auction.id),
                         index_position: 1,
                         key_type: "i64",
                         lower_bound: auction.id.toString(),
@@ -480,73 +993,757 @@ describe("getbit", () => {
                         AuctionStatus.WINNER_SELECTED
                     )
                 );
+
+                const escrows: EscrowRow[] = await contract.tables.escrow({
+                    scope: auction.id.toString(),
+                });
+                expect(escrows.length).toEqual(0);
+
+                const wins: WinRow[] = await contract.tables.win({
+                    scope: auction.winner,
+                    lower_bound: auction.id.toString(),
+                    upper_bound: auction.id.toString(),
+                });
+                expect(wins.length).toEqual(1);
+                expect(wins[0].winner_number).toEqual(auction.winner_number);
+                expect(wins[0].archived).toEqual(0);
             });
         });
 
-        it(`should end and select winner of ${auctionTest.length} auctions`, async () => {
-            const existingTenderTen = await contract.tables.auction({
-                scope: contractAccount,
-                index_position: 2,
-                key_type: "i64",
-                lower_bound: Object.keys(AuctionType)
-                    .indexOf(AuctionType.TENDER_TEN)
-                    .toString(),
-                upper_bound: Object.keys(AuctionType)
-                    .indexOf(AuctionType.TENDER_TEN)
-                    .toString(),
-            });
+        it("should not select winners of auctions already selected", async () => {
+            await expect(async () => {
+                await contract.actions.selwinners(
+                    {
+                        winners: auctionTest.map((auction) => ({
+                            id: auction.id,
+                            winner: auction.winner,
+                            winner_number: auction.winner_number,
+                            winner_txhash: auction.winner_txhash,
+                            private_key: auction.private_key,
+                        })),
+                        skip_failures: false,
+                    },
+                    [
+                        {
+                            actor: contractAccount,
+                            permission: "active",
+                        },
+                    ]
+                );
+            }).rejects.toThrowError(
+                "assertion failure with message: The auction is not in calculation"
+            );
+        });
 
-            const existingMegaTender = await contract.tables.auction({
-                scope: contractAccount,
-                index_position: 2,
-                key_type: "i64",
-                lower_bound: Object.keys(AuctionType)
-                    .indexOf(AuctionType.MEGA_TENDER)
-                    .toString(),
-                upper_bound: Object.keys(AuctionType)
-                    .indexOf(AuctionType.MEGA_TENDER)
-                    .toString(),
-            });
+        it(`should end and select winner of ${auctionTest.length} auctions`, async () => {
+            const statusTypeKey = (status: AuctionStatus, type: AuctionType) =>
+                `0x${Object.keys(AuctionStatus).indexOf(status).toString(16)}${Object.keys(AuctionType)
+                    .indexOf(type)
+                    .toString(16)
+                    .padStart(8, "0")}`;
+            const [existingTenderTen, existingMegaTender] = await Promise.all(
+                [AuctionType.TENDER_TEN, AuctionType.MEGA_TENDER].map((type) =>
+                    contract.tables.auctionv2({
+                        scope: auctionScope(auctionTest[0].id),
+                        index_position: 2,
+                        key_type: "i128",
+                        lower_bound: `${statusTypeKey(AuctionStatus.WINNER_SELECTED, type)}00000000`,
+                        upper_bound: `${statusTypeKey(AuctionStatus.WINNER_SELECTED, type)}ffffffff`,
+                        limit: 100,
+                    })
+                )
+            );
 
             expect(
                 existingTenderTen.length + existingMegaTender.length
             ).toBeGreaterThanOrEqual(auctionTest.length);
+            expect(
+                existingTenderTen.length
+            ).toBeGreaterThanOrEqual(
+                auctionTest.filter((auction) => auction.type === AuctionType.TENDER_TEN).length
+            );
+        });
+
+        it("should query auctions and balances", async () => {
+            const status = Object.keys(AuctionStatus).indexOf(
+                AuctionStatus.WINNER_SELECTED
+            );
+            const type = Object.keys(AuctionType).indexOf(AuctionType.TENDER_TEN);
+            const auctionResult: any = await contract.actions.getauctions(
+                {
+                    status,
+                    type,
+                    cursor: 0,
+                    limit: 1,
+                },
+                [
+                    {
+                        actor: contractAccount,
+                        permission: "active",
+                    },
+                ]
+            );
+            const page: AuctionPage =
+                auctionResult.processed.action_traces[0].return_value_data;
+            expect(page.rows.length).toEqual(1);
+            expect(page.rows[0].status).toEqual(status);
+            expect(page.rows[0].type).toEqual(type);
+
+            const balanceResult: any = await contract.actions.getbalances(
+                {
+                    owners: testAccounts,
+                    symbol: `0,${symbol}`,
+                },
+                [
+                    {
+                        actor: contractAccount,
+                        permission: "active",
+                    },
+                ]
+            );
+            const balances: string[] =
+                balanceResult.processed.action_traces[0].return_value_data;
+            expect(balances.length).toEqual(testAccounts.length);
+            for (let i = 0; i < testAccounts.length; i++) {
+                const accountResult: AccountRow[] = await contract.tables.account({
+                    scope: testAccounts[i],
+                });
+                expect(balances[i]).toEqual(accountResult[0].balance);
+            }
+        });
+
+        it(`should end bidding of an auction at its end time`, async () => {
+            // Of the type with the winner selected by the operator
+            const auction: AuctionRow = {
+                ...auctionTest[1],
+                id: auctionTest.length,
+                end_time: new Date(Date.now() + 3000).toISOString().slice(0, -1),
+            };
+            const bidding = bidTest[0];
 
-            const existingWinnerSelectedAuctions =
-                await contract.tables.auction({
+            try {
+                const actionResult = await contract.actions.biddingstart(
+                    {
+                        id: auction.id,
+                        symbol: `0,${auction.symbol}`,
+                        type: auction.type,
+                        prize: auction.prize,
+                        public_key: auction.public_key,
+                        ticket_price: auction.ticket_price,
+                        end_time: auction.end_time,
+                    },
+                    [
+                        {
+                            actor: contractAccount,
+                            permission: "active",
+                        },
+                    ]
+                );
+                expect(actionResult).toHaveProperty("transaction_id");
+            } catch (error) {
+                throw error;
+            }
+
+            await new Promise((resolve) => setTimeout(resolve, 5000));
+
+            await expect(async () => {
+                await contract.actions.bid(
+                    {
+                        bidder: bidding.bidder,
+                        auction_id: auction.id,
+                        quantity: `${bidding.amount} ${symbol}`,
+                        entries: bidding.entries,
+                        hash: bidding.hash,
+                    },
+                    [
+                        {
+                            actor: bidding.bidder,
+                            permission: "active",
+                        },
+                    ]
+                );
+            }).rejects.toThrowError(
+                "assertion failure with message: The auction was already ended"
+            );
+
+            // Found as ended before its status is stored
+            const getAuctions = async (status: AuctionStatus, cursor: number) => {
+                const auctionResult: any = await contract.actions.getauctions(
+                    {
+                        status: Object.keys(AuctionStatus).indexOf(status),
+                        type: Object.keys(AuctionType).indexOf(auction.type),
+                        cursor,
+                        limit: 1,
+                    },
+                    [
+                        {
+                            actor: contractAccount,
+                            permission: "active",
+                        },
+                    ]
+                );
+                const page: AuctionPage =
+                    auctionResult.processed.action_traces[0].return_value_data;
+                return page;
+            };
+            const endedPage = await getAuctions(
+                AuctionStatus.WINNER_CALCULATION,
+                auction.id
+            );
+            expect(endedPage.rows.length).toEqual(1);
+            expect(endedPage.rows[0].id).toEqual(auction.id);
+            expect(endedPage.rows[0].status).toEqual(
+                Object.keys(AuctionStatus).indexOf(AuctionStatus.WINNER_CALCULATION)
+            );
+            const biddingPage = await getAuctions(AuctionStatus.BIDDING, auction.id);
+            expect(
+                biddingPage.rows.find((row) => row.id === auction.id)
+            ).toBeUndefined();
+            await expect(async () => {
+                await getAuctions(AuctionStatus.BIDDING, 2 ** 32);
+            }).rejects.toThrowError(
+                "assertion failure with message: Cursor must be less than 2^32"
+            );
+
+            // Selected without biddingend
+            try {
+                const actionResult = await contract.actions.selectwinner(
+                    {
+                        id: auction.id,
+                        winner: auction.winner,
+                        winner_number: auction.winner_number,
+                        winner_txhash: auction.winner_txhash,
+                        private_key: auction.private_key,
+                    },
+                    [
+                        {
+                            actor: contractAccount,
+                            permission: "active",
+                        },
+                    ]
+                );
+                expect(actionResult).toHaveProperty("transaction_id");
+            } catch (error) {
+                throw error;
+            }
+
+            const auctions: AuctionRow[] = await contract.tables.auctionv2({
+                scope: auctionScope(auction.id),
+                index_position: 1,
+                key_type: "i64",
+                lower_bound: auction.id.toString(),
+                upper_bound: auction.id.toString(),
+            });
+            expect(auctions.length).toEqual(1);
+            expect(auctions[0].status).toEqual(
+                Object.keys(AuctionStatus).indexOf(AuctionStatus.WINNER_SELECTED)
+            );
+        }, 20000);
+
+        // Bids not of the winner are refunded at 60%, and the winner is paid 40% of the pot
+        const refundBps = 6000;
+        const payoutBps = 4000;
+
+        it(`should not set rates paying out more than the pot`, async () => {
+            await expect(async () => {
+                await contract.actions.setsettle(
+                    {
+                        refund_bps: 10000,
+                        payout_bps: 5000,
+                    },
+                    [
+                        {
+                            actor: contractAccount,
+                            permission: "active",
+                        },
+                    ]
+                );
+            }).rejects.toThrowError(
+                "assertion failure with message: Refund and payout rates must be within 10000 in total"
+            );
+        });
+
+        it(`should set the rates to settle at`, async () => {
+            try {
+                const actionResult = await contract.actions.setsettle(
+                    {
+                        refund_bps: refundBps,
+                        payout_bps: payoutBps,
+                    },
+                    [
+                        {
+                            actor: contractAccount,
+                            permission: "active",
+                        },
+                    ]
+                );
+                expect(actionResult).toHaveProperty("transaction_id");
+            } catch (error) {
+                throw error;
+            }
+
+            const configResult: ConfigRow[] = await contract.tables.config();
+            expect(configResult[0].refund_bps).toEqual(refundBps);
+            expect(configResult[0].payout_bps).toEqual(payoutBps);
+        });
+
+        auctionTest.forEach((auction, index) => {
+            it(`should settle auction #${index} in chunks`, async () => {
+                const maxRows = 2;
+                const auctionKey = auction.id.toString(16);
+                const bids: BidRow[] = await contract.tables.bid({
                     scope: contractAccount,
                     index_position: 3,
+                    key_type: "i128",
+                    lower_bound: `0x${auctionKey}0000000000000000`,
+                    upper_bound: `0x${auctionKey}ffffffffffffffff`,
+                    limit: 100,
+                });
+
+                const credits: { [bidder: string]: number } = {};
+                bids.filter((bidding) => bidding.bidder !== auction.winner).forEach(
+                    (bidding) => {
+                        credits[bidding.bidder] =
+                            (credits[bidding.bidder] ?? 0) +
+                            Math.floor(
+                                (+bidding.quantity.split(" ")[0] * refundBps) / 10000
+                            );
+                    }
+                );
+                const pot = bids.reduce(
+                    (sum, bidding) => sum + +bidding.quantity.split(" ")[0],
+                    0
+                );
+                credits[auction.winner] =
+                    (credits[auction.winner] ?? 0) +
+                    Math.floor((pot * payoutBps) / 10000);
+                const getBalance = async (account: string) => {
+                    const accountResult: AccountRow[] =
+                        await contract.tables.account({
+                            scope: account,
+                        });
+                    return +accountResult[0].balance.split(" ")[0];
+                };
+                const beforeBalances = await Promise.all(
+                    testAccounts.map(getBalance)
+                );
+
+                const chunks = Math.max(1, Math.ceil(bids.length / maxRows));
+                for (let chunk = 0; chunk < chunks; chunk++) {
+                    try {
+                        const actionResult = await contract.actions.settle(
+                            {
+                                auction_id: auction.id,
+                                max_rows: maxRows,
+                            },
+                            [
+                                {
+                                    actor: contractAccount,
+                                    permission: "active",
+                                },
+                            ]
+                        );
+                        expect(actionResult).toHaveProperty("transaction_id");
+                    } catch (error) {
+                        throw error;
+                    }
+                }
+
+                const auctions: AuctionRow[] = await contract.tables.auctionv2({
+                    scope: auctionScope(auction.id),
+                    index_position: 1,
                     key_type: "i64",
-                    lower_bound: Object.keys(AuctionStatus)
-                        .indexOf(AuctionStatus.WINNER_SELECTED)
-                        .toString(),
-                    upper_bound: Object.keys(AuctionStatus)
-                        .indexOf(AuctionStatus.WINNER_SELECTED)
-                        .toString(),
+                    lower_bound: auction.id.toString(),
+                    upper_bound: auction.id.toString(),
                 });
+                expect(auctions.length).toEqual(1);
+                expect(auctions[0].status).toEqual(
+                    Object.keys(AuctionStatus).indexOf(AuctionStatus.SETTLED)
+                );
+                expect(auctions[0].settled_count).toEqual(bids.length);
 
-            expect(
-                existingWinnerSelectedAuctions.length
-            ).toBeGreaterThanOrEqual(auctionTest.length);
+                const afterBalances = await Promise.all(
+                    testAccounts.map(getBalance)
+                );
+                testAccounts.forEach((account, accountIndex) => {
+                    expect(
+                        afterBalances[accountIndex] - beforeBalances[accountIndex]
+                    ).toEqual(credits[account] ?? 0);
+                });
+
+                // Refunds and the payout come out of the pot only
+                const paidOut = testAccounts.reduce(
+                    (sum, account, accountIndex) =>
+                        sum + afterBalances[accountIndex] - beforeBalances[accountIndex],
+                    0
+                );
+                expect(paidOut).toBeLessThanOrEqual(
+                    +auctions[0].total_amount.split(" ")[0]
+                );
+            });
         });
 
-        it(`should clean the auction table`, async () => {
+        it(`should archive ${auctionTest.length} auctions settled`, async () => {
             try {
-                const actionResult = await contract.actions.clear({}, [
+                const actionResult = await contract.actions.archive(
                     {
-                        actor: contractAccount,
-                        permission: "active",
+                        max_rows: auctionTest.length,
+                    },
+                    [
+                        {
+                            actor: contractAccount,
+                            permission: "active",
+                        },
+                    ]
+                );
+                expect(actionResult).toHaveProperty("transaction_id");
+            } catch (error) {
+                throw error;
+            }
+
+            const archives: ArchiveRow[] = await contract.tables.archive({
+                scope: contractAccount,
+            });
+            auctionTest.forEach((auction) => {
+                const archived = archives.find((row) => row.id === auction.id);
+                expect(archived).toBeDefined();
+                expect(archived?.winner).toEqual(auction.winner);
+                expect(archived?.winner_number).toEqual(auction.winner_number);
+            });
+
+            for (const auction of auctionTest) {
+                const wins: WinRow[] = await contract.tables.win({
+                    scope: auction.winner,
+                    lower_bound: auction.id.toString(),
+                    upper_bound: auction.id.toString(),
+                });
+                expect(wins.length).toEqual(1);
+                expect(wins[0].archived).toEqual(1);
+            }
+
+            const auctions: AuctionRow[] = await contract.tables.auctionv2({
+                scope: auctionScope(auctionTest[0].id),
+            });
+            auctionTest.forEach((auction) => {
+                expect(auctions.find((row) => row.id === auction.id)).toBeUndefined();
+            });
+        });
+
+        it("should migrate auctions stored as text", async () => {
+            const legacyAuction = {
+                symbol: `0,${symbol}`,
+                type: Object.keys(AuctionType).indexOf(AuctionType.TENDER_TEN),
+                status: Object.keys(AuctionStatus).indexOf(
+                    AuctionStatus.WINNER_SELECTED
+                ),
+                prize: "100 USDT",
+                winner: testAccounts[0],
+                winner_number: "1234",
+            };
+            // Bytes of OTHER_PRIVATE_KEY, also in PVT_K1_ text
+            const privateKey =
+                "8bd9f023ca64deb721c7d68f8aed9c7414076767d4c276f1f106624f34205cdc";
+            const privateKeyK1 =
+                "PVT_K1_24bKEF8AE2i6qECmYxF3KCu5dmywjckDhGWkM7QpbZdMvPMdzu";
+            // Stored without aggregates, as in the first layout
+            const legacyAuctions: LegacyAuctionRow[] = [
+                {
+                    ...legacyAuction,
+                    id: 100,
+                    public_key: OTHER_PUBLIC_KEY,
+                    winner_txhash: "c3".repeat(32),
+                    private_key: OTHER_PRIVATE_KEY,
+                },
+                // Text not parsed is left to fix
+                {
+                    ...legacyAuction,
+                    id: 101,
+                    public_key: "publickey",
+                    winner_txhash: "txhash",
+                    private_key: "privatekey",
+                },
+                {
+                    ...legacyAuction,
+                    id: 102,
+                    public_key: "",
+                    winner_txhash: "",
+                    private_key: privateKeyK1,
+                },
+                {
+                    ...legacyAuction,
+                    id: 2 ** 32,
+                    public_key: "",
+                    winner_txhash: "",
+                    private_key: "",
+                },
+            ];
+            const zeroPublicKey = "EOS1111111111111111111111111111111114T1Anm";
+
+            try {
+                const actionResult = await contract.actions.putlegacy(
+                    {
+                        rows: legacyAuctions,
                     },
-                ]);
+                    [
+                        {
+                            actor: contractAccount,
+                            permission: "active",
+                        },
+                    ]
+                );
                 expect(actionResult).toHaveProperty("transaction_id");
             } catch (error) {
                 throw error;
             }
 
-            const auctions: AuctionRow[] = await contract.tables.auction({
+            await expect(async () => {
+                await contract.actions.biddingstart(
+                    {
+                        id: legacyAuctions[0].id,
+                        symbol: `0,${symbol}`,
+                        type: auctionTest[0].type,
+                        prize: auctionTest[0].prize,
+                        public_key: auctionTest[0].public_key,
+                        ticket_price: auctionTest[0].ticket_price,
+                        end_time: auctionTest[0].end_time,
+                    },
+                    [
+                        {
+                            actor: contractAccount,
+                            permission: "active",
+                        },
+                    ]
+                );
+            }).rejects.toThrowError(
+                "assertion failure with message: The auction already exists for id"
+            );
+
+            // Migrated in chunks, and done again without failing on auctions left
+            for (let chunk = 0; chunk < legacyAuctions.length + 1; chunk++) {
+                const migrateResult: any = await contract.actions.migrate(
+                    {
+                        max_rows: 1,
+                    },
+                    [
+                        {
+                            actor: contractAccount,
+                            permission: "active",
+                        },
+                    ]
+                );
+                const failures: { id: number; error: string }[] =
+                    migrateResult.processed.action_traces[0].return_value_data;
+                const unparsedFailure = [
+                    "101",
+                    "Fields not parsed: public_key, winner_txhash, private_key",
+                ];
+                const expectedFailures = [
+                    [],
+                    [unparsedFailure],
+                    [],
+                    [["4294967296", "Auction ID must be less than 2^32"]],
+                    [unparsedFailure],
+                ];
+                expect(
+                    failures.map((failure) => [String(failure.id), failure.error])
+                ).toEqual(expectedFailures[chunk]);
+            }
+
+            const auctions: AuctionRow[] = await contract.tables.auctionv2({
+                scope: auctionScope(legacyAuctions[0].id),
+                lower_bound: legacyAuctions[0].id.toString(),
+                upper_bound: legacyAuctions[2].id.toString(),
+            });
+            expect(auctions.map((auction) => auction.id)).toEqual([
+                legacyAuctions[0].id,
+                legacyAuctions[2].id,
+            ]);
+            auctions.forEach((auction) => {
+                expect(auction.winner_number).toEqual(1234);
+                expect(auction.private_key).toEqual(privateKey);
+                expect(auction.total_amount).toEqual(`0 ${symbol}`);
+            });
+            expect(auctions[0].public_key).toEqual(OTHER_PUBLIC_KEY);
+            expect(auctions[0].winner_txhash).toEqual("c3".repeat(32));
+            expect(auctions[1].public_key).toEqual(zeroPublicKey);
+            expect(auctions[1].winner_txhash).toEqual("00".repeat(32));
+
+            // Auctions migrated with winner selected are won by their winner
+            const wins: WinRow[] = await contract.tables.win({
+                scope: legacyAuction.winner,
+                lower_bound: legacyAuctions[0].id.toString(),
+                upper_bound: legacyAuctions[2].id.toString(),
+            });
+            expect(wins.map((row) => row.auction_id)).toEqual([
+                legacyAuctions[0].id,
+                legacyAuctions[2].id,
+            ]);
+            wins.forEach((row) => {
+                expect(row.winner_number).toEqual(1234);
+                expect(row.archived).toEqual(0);
+            });
+
+            // Left as stored, so no text is lost
+            const legacyRows: LegacyAuctionRow[] = await contract.tables.auction({
                 scope: contractAccount,
             });
+            const withTextId = (row: LegacyAuctionRow) => ({
+                ...row,
+                id: String(row.id),
+            });
+            expect(legacyRows.map(withTextId)).toEqual(
+                [legacyAuctions[1], legacyAuctions[3]].map(withTextId)
+            );
+        });
+
+        it(`should clean the auction table in chunks`, async () => {
+            const maxRows = 2;
+
+            // Bids of an auction not selected are refunded from its escrow
+            const auction: AuctionRow = {
+                ...auctionTest[0],
+                id: auctionTest.length + 1,
+            };
+            const bidding = bidTest[0];
+            await contract.actions.biddingstart(
+                {
+                    id: auction.id,
+                    symbol: `0,${auction.symbol}`,
+                    type: auction.type,
+                    prize: auction.prize,
+                    public_key: auction.public_key,
+                    ticket_price: auction.ticket_price,
+                    end_time: auction.end_time,
+                },
+                [
+                    {
+                        actor: contractAccount,
+                        permission: "active",
+                    },
+                ]
+            );
+            await contract.actions.bid(
+                {
+                    bidder: bidding.bidder,
+                    auction_id: auction.id,
+                    quantity: `${bidding.amount} ${symbol}`,
+                    entries: bidding.entries,
+                    hash: bidding.hash,
+                },
+                [
+                    {
+                        actor: bidding.bidder,
+                        permission: "active",
+                    },
+                ]
+            );
+            const getBalance = async (account: string) => {
+                const accountResult: AccountRow[] = await contract.tables.account({
+                    scope: account,
+                });
+                return +accountResult[0].balance.split(" ")[0];
+            };
+            const beforeBalance = await getBalance(bidding.bidder);
+
+            const auctionRows: AuctionRow[] = await contract.tables.auctionv2({
+                scope: auctionScope(auctionTest[0].id),
+                limit: 100,
+            });
+            const bidRows: BidRow[] = await contract.tables.bid({
+                scope: contractAccount,
+                limit: 100,
+            });
+            const archiveRows: ArchiveRow[] = await contract.tables.archive({
+                scope: contractAccount,
+                limit: 100,
+            });
+            const getBuckets = async (auctionId: number) => {
+                const bucketRows: NumberBucketRow[] = await contract.tables.number({
+                    scope: auctionId.toString(),
+                    limit: 200,
+                });
+                return bucketRows;
+            };
+            const bucketCounts = await Promise.all(
+                auctionRows.map(async (row) => (await getBuckets(row.id)).length)
+            );
+            const bucketRowCount = bucketCounts.reduce((sum, count) => sum + count, 0);
+            expect(bucketRowCount).toBeGreaterThan(0);
+            const chunks = Math.ceil(
+                (auctionRows.length +
+                    bidRows.length +
+                    archiveRows.length +
+                    bucketRowCount) /
+                    maxRows
+            );
+
+            for (let chunk = 0; chunk < chunks; chunk++) {
+                try {
+                    const actionResult = await contract.actions.clear(
+                        {
+                            max_rows: maxRows,
+                        },
+                        [
+                            {
+                                actor: contractAccount,
+                                permission: "active",
+                            },
+                        ]
+                    );
+                    expect(actionResult).toHaveProperty("transaction_id");
+                } catch (error) {
+                    throw error;
+                }
+            }
+
+            const auctions: AuctionRow[] = await contract.tables.auctionv2({
+                scope: auctionScope(auctionTest[0].id),
+            });
             expect(auctions.length).toEqual(0);
+
+            const epochs: EpochRow[] = await contract.tables.epoch({
+                scope: contractAccount,
+            });
+            expect(epochs.length).toEqual(0);
+
+            const bids: BidRow[] = await contract.tables.bid({
+                scope: contractAccount,
+            });
+            expect(bids.length).toEqual(0);
+
+            // Rows are erased with their secondary keys
+            for (const index_position of [2, 3]) {
+                const indexedBids: BidRow[] = await contract.tables.bid({
+                    scope: contractAccount,
+                    index_position,
+                    key_type: "i128",
+                });
+                expect(indexedBids.length).toEqual(0);
+            }
+            const indexedAuctions: AuctionRow[] = await contract.tables.auctionv2({
+                scope: auctionScope(auctionTest[0].id),
+                index_position: 2,
+                key_type: "i128",
+            });
+            expect(indexedAuctions.length).toEqual(0);
+
+            const archives: ArchiveRow[] = await contract.tables.archive({
+                scope: contractAccount,
+            });
+            expect(archives.length).toEqual(0);
+
+            const escrows: EscrowRow[] = await contract.tables.escrow({
+                scope: auction.id.toString(),
+            });
+            expect(escrows.length).toEqual(0);
+
+            // Numbers chosen are cleaned with their auctions
+            for (const row of auctionRows) {
+                expect((await getBuckets(row.id)).length).toEqual(0);
+            }
+            expect((await getBalance(bidding.bidder)) - beforeBalance).toEqual(
+                bidding.amount
+            );
         });
     });
 });
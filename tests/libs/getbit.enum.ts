@@ -7,4 +7,5 @@ export enum AuctionStatus {
     BIDDING = "BIDDING",
     WINNER_CALCULATION = "WINNER_CALCULATION",
     WINNER_SELECTED = "WINNER_SELECTED",
+    SETTLED = "SETTLED",
 }
@@ -6,6 +6,10 @@ export interface AccountRow {
     balance: string;
 }
 
+export interface EscrowRow {
+    balance: string;
+}
+
 export interface AuctionRow {
     id: number;
     symbol: string;
@@ -14,7 +18,108 @@ export interface AuctionRow {
     prize: string;
     public_key: string;
     winner: string;
+    winner_number: number;
+    winner_txhash: string;
+    private_key: string;
+    total_amount: string;
+    bid_count: number;
+    bidder_count: number;
+    settled_count: number;
+    ticket_price: string;
+    end_time: string;
+}
+
+export interface LegacyAuctionRow {
+    id: number;
+    symbol: string;
+    type: number;
+    status: number;
+    prize: string;
+    public_key: string;
+    winner: string;
     winner_number: string;
     winner_txhash: string;
     private_key: string;
 }
+
+export interface BidRow {
+    id: number;
+    auction_id: number;
+    sequence: number;
+    bidder: string;
+    quantity: string;
+    entries: string;
+    hash: string;
+}
+
+export interface NumberBucketRow {
+    id: number;
+    once: number | string;
+    many: number | string;
+    first_bids: (number | string)[];
+}
+
+export interface WinRow {
+    auction_id: number;
+    type: number;
+    prize: string;
+    winner_number: number;
+    total_amount: string;
+    archived: number;
+}
+
+export interface EpochRow {
+    id: number;
+    auction_count: number;
+}
+
+export interface ParticipationRow {
+    auction_id: number;
+    bid_count: number;
+    total_amount: string;
+}
+
+export interface ConfigRow {
+    symbols: string[];
+    max_bids: number;
+    refund_bps: number;
+    payout_bps: number;
+}
+
+export interface BidReceipt {
+    auction_id: number;
+    sequence: number;
+    balance: string;
+    pot: string;
+}
+
+export interface ArchiveRow {
+    id: number;
+    symbol: string;
+    type: number;
+    prize: string;
+    winner: string;
+    winner_number: number;
+    total_amount: string;
+    bid_count: number;
+    bidder_count: number;
+}
+
+export interface AuctionView {
+    id: number;
+    status: number;
+    type: number;
+    prize: string;
+    winner: string;
+    total_amount: string;
+    bid_count: number;
+    bidder_count: number;
+    ticket_price: string;
+    end_time: string;
+}
+
+export interface AuctionPage {
+    rows: AuctionView[];
+    more: boolean;
+    next_cursor: number;
+}
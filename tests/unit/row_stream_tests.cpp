@@ -0,0 +1,307 @@
+/**
+ *  @file
+ *  @brief Native unit tests of the row stream of the contract
+ *  (getbit/include/row_stream.hpp), against an in-memory database.
+ */
+
+#include <eosio/tester.hpp>
+#include <eosio/binary_extension.hpp>
+#include <row_stream.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+#include <tuple>
+
+using eosio::native::intrinsics;
+
+namespace {
+   struct test_row {
+      uint64_t                           id;
+      uint128_t                          first;
+      uint128_t                          second;
+      eosio::binary_extension<uint64_t>  extra;
+
+      uint64_t primary_key() const { return id; }
+
+      EOSLIB_SERIALIZE( test_row, (id)(first)(second)(extra) )
+   };
+
+   // Layout of the rows before the extension was added
+   struct test_row_v0 {
+      uint64_t  id;
+      uint128_t first;
+      uint128_t second;
+
+      EOSLIB_SERIALIZE( test_row_v0, (id)(first)(second) )
+   };
+
+   typedef eosio::row_stream<"row"_n, test_row, 2> test_stream;
+
+   const eosio::name code = "getbit"_n;
+   const uint64_t    scope = 7;
+
+   // Iterators index the entries handed out so far, end iterators are -2 less
+   // the number of the table (-1 when the table does not exist)
+   struct mock_db {
+      typedef std::tuple<uint64_t, uint64_t, uint64_t> table_key;
+
+      std::map<table_key, std::map<uint64_t, std::vector<char>>>   primary;
+      std::map<table_key, std::set<std::pair<uint128_t, uint64_t>>> secondary;
+      std::vector<std::pair<table_key, uint64_t>>                   primary_itrs;
+      std::vector<std::pair<table_key, std::pair<uint128_t, uint64_t>>> secondary_itrs;
+      std::vector<table_key>                                        tables;
+      uint64_t                                                      reads = 0;
+
+      int32_t end_of(const table_key& t) {
+         for( size_t i = 0; i < tables.size(); ++i ) {
+            if( tables[i] == t ) {
+               return -2 - int32_t(i);
+            }
+         }
+         tables.push_back(t);
+         return -1 - int32_t(tables.size());
+      }
+
+      int32_t primary_itr(const table_key& t, uint64_t pk) {
+         primary_itrs.emplace_back(t, pk);
+         return int32_t(primary_itrs.size() - 1);
+      }
+
+      int32_t secondary_itr(const table_key& t, const std::pair<uint128_t, uint64_t>& key) {
+         secondary_itrs.emplace_back(t, key);
+         return int32_t(secondary_itrs.size() - 1);
+      }
+
+      template <typename Row>
+      void store(const Row& r) {
+         const uint64_t table = ("row"_n).value;
+         primary[{ code.value, scope, table }][r.id] = eosio::pack(r);
+         secondary[{ code.value, scope, table & 0xFFFFFFFFFFFFFFF0ULL }].emplace(r.first, r.id);
+         secondary[{ code.value, scope, (table & 0xFFFFFFFFFFFFFFF0ULL) | 1 }].emplace(r.second, r.id);
+      }
+
+      size_t count(uint64_t table) {
+         return primary[{ code.value, scope, table }].size();
+      }
+
+      size_t count_secondary(uint64_t index) {
+         const uint64_t table = ("row"_n).value;
+         return secondary[{ code.value, scope, (table & 0xFFFFFFFFFFFFFFF0ULL) | index }].size();
+      }
+   };
+
+   mock_db db;
+
+   void setup_db(uint64_t rows) {
+      db = mock_db{};
+      for( uint64_t id = 0; id < rows; ++id ) {
+         // Secondary keys run opposite to and across primary keys
+         db.store(test_row{ id, uint128_t(rows - id), uint128_t(id % 3) << 64 | id });
+      }
+
+      intrinsics::set_intrinsic<intrinsics::db_lowerbound_i64>(
+         [](uint64_t c, uint64_t s, uint64_t t, uint64_t lower) -> int32_t {
+            const mock_db::table_key key{ c, s, t };
+            const auto table = db.primary.find(key);
+            if( table == db.primary.end() ) {
+               return -1;
+            }
+            const auto itr = table->second.lower_bound(lower);
+            return itr == table->second.end() ? db.end_of(key) : db.primary_itr(key, itr->first);
+         });
+      intrinsics::set_intrinsic<intrinsics::db_find_i64>(
+         [](uint64_t c, uint64_t s, uint64_t t, uint64_t pk) -> int32_t {
+            const mock_db::table_key key{ c, s, t };
+            const auto table = db.primary.find(key);
+            if( table == db.primary.end() ) {
+               return -1;
+            }
+            return table->second.count(pk) ? db.primary_itr(key, pk) : db.end_of(key);
+         });
+      intrinsics::set_intrinsic<intrinsics::db_next_i64>(
+         [](int32_t itr, uint64_t* pk) -> int32_t {
+            const auto entry = db.primary_itrs.at(itr);
+            auto&      table = db.primary.at(entry.first);
+            const auto next  = table.upper_bound(entry.second);
+            if( next == table.end() ) {
+               return db.end_of(entry.first);
+            }
+            *pk = next->first;
+            return db.primary_itr(entry.first, next->first);
+         });
+      intrinsics::set_intrinsic<intrinsics::db_get_i64>(
+         [](int32_t itr, const void* data, uint32_t len) -> int32_t {
+            const auto  entry = db.primary_itrs.at(itr);
+            const auto& value = db.primary.at(entry.first).at(entry.second);
+            if( len > 0 ) {
+               db.reads++;
+               std::memcpy(const_cast<void*>(data), value.data(), std::min<size_t>(len, value.size()));
+            }
+            return int32_t(value.size());
+         });
+      intrinsics::set_intrinsic<intrinsics::db_remove_i64>(
+         [](int32_t itr) {
+            const auto entry = db.primary_itrs.at(itr);
+            eosio::check(db.primary.at(entry.first).erase(entry.second) == 1, "Row erased twice");
+         });
+      intrinsics::set_intrinsic<intrinsics::db_idx128_lowerbound>(
+         [](uint64_t c, uint64_t s, uint64_t t, uint128_t* secondary, uint64_t* pk) -> int32_t {
+            const mock_db::table_key key{ c, s, t };
+            const auto index = db.secondary.find(key);
+            if( index == db.secondary.end() ) {
+               return -1;
+            }
+            const auto itr = index->second.lower_bound({ *secondary, 0 });
+            if( itr == index->second.end() ) {
+               return db.end_of(key);
+            }
+            *secondary = itr->first;
+            *pk        = itr->second;
+            return db.secondary_itr(key, *itr);
+         });
+      intrinsics::set_intrinsic<intrinsics::db_idx128_next>(
+         [](int32_t itr, uint64_t* pk) -> int32_t {
+            const auto entry = db.secondary_itrs.at(itr);
+            auto&      index = db.secondary.at(entry.first);
+            const auto next  = index.upper_bound(entry.second);
+            if( next == index.end() ) {
+               return db.end_of(entry.first);
+            }
+            *pk = next->second;
+            return db.secondary_itr(entry.first, *next);
+         });
+      intrinsics::set_intrinsic<intrinsics::db_idx128_find_primary>(
+         [](uint64_t c, uint64_t s, uint64_t t, uint128_t* secondary, uint64_t pk) -> int32_t {
+            const mock_db::table_key key{ c, s, t };
+            for( const auto& entry : db.secondary[key] ) {
+               if( entry.second == pk ) {
+                  *secondary = entry.first;
+                  return db.secondary_itr(key, entry);
+               }
+            }
+            return db.end_of(key);
+         });
+      intrinsics::set_intrinsic<intrinsics::db_idx128_remove>(
+         [](int32_t itr) {
+            const auto entry = db.secondary_itrs.at(itr);
+            eosio::check(db.secondary.at(entry.first).erase(entry.second) == 1, "Key erased twice");
+         });
+   }
+}
+
+// Rows are read in primary key order from the lower bound, each unpacked once
+EOSIO_TEST_BEGIN(primary_stream_test)
+   setup_db(10);
+
+   uint64_t expected = 4;
+   for( test_stream rows(code, scope, 4); rows; ++rows ) {
+      CHECK_EQUAL( rows->id, expected );
+      CHECK_EQUAL( (*rows).first, uint128_t(10 - expected) );
+      expected++;
+   }
+   CHECK_EQUAL( expected, 10u );
+   CHECK_EQUAL( db.reads, 6u );
+
+   // Rows only counted are never unpacked
+   uint64_t count = 0;
+   for( test_stream rows(code, scope, 0); rows; ++rows ) {
+      count++;
+   }
+   CHECK_EQUAL( count, 10u );
+   CHECK_EQUAL( db.reads, 6u );
+
+   CHECK_EQUAL( bool(test_stream(code, scope, 10)), false );
+   CHECK_EQUAL( bool(test_stream(code, scope + 1, 0)), false );
+EOSIO_TEST_END
+
+// Rows are read in secondary key order from the lower bound
+EOSIO_TEST_BEGIN(secondary_stream_test)
+   setup_db(10);
+
+   uint64_t expected = 9;
+   for( test_stream rows(code, scope, 0, uint128_t(1)); rows; ++rows ) {
+      CHECK_EQUAL( rows->id, expected );
+      expected--;
+   }
+   CHECK_EQUAL( expected, UINT64_MAX );
+
+   // Keys of the second index group by id % 3, ordered by id within each group
+   std::vector<uint64_t> ids;
+   for( test_stream rows(code, scope, 1, uint128_t(1) << 64); rows; ++rows ) {
+      ids.push_back(rows->id);
+   }
+   CHECK_EQUAL( ids, (std::vector<uint64_t>{ 1, 4, 7, 2, 5, 8 }) );
+
+   CHECK_EQUAL( bool(test_stream(code, scope, 0, uint128_t(11))), false );
+   CHECK_ASSERT( "Secondary index does not exist", []() { test_stream(code, scope, 2, 0); } );
+EOSIO_TEST_END
+
+// Rows erased go with their secondary keys, rows before the cursor are kept
+EOSIO_TEST_BEGIN(erase_stream_test)
+   setup_db(1000);
+   const uint64_t table = ("row"_n).value;
+
+   uint64_t erased = 0;
+   for( test_stream rows(code, scope, 600); rows; ) {
+      CHECK_EQUAL( rows->id, 600 + erased );
+      rows.erase();
+      erased++;
+   }
+   CHECK_EQUAL( erased, 400u );
+   CHECK_EQUAL( db.count(table), 600u );
+   CHECK_EQUAL( db.count_secondary(0), 600u );
+   CHECK_EQUAL( db.count_secondary(1), 600u );
+
+   // Erasing while streaming by a secondary index moves on to the next key
+   std::vector<uint64_t> ids;
+   for( test_stream rows(code, scope, 1, uint128_t(2) << 64); rows; ) {
+      ids.push_back(rows->id);
+      rows.erase();
+   }
+   CHECK_EQUAL( ids.size(), 200u );
+   CHECK_EQUAL( ids.front(), 2u );
+   CHECK_EQUAL( ids.back(), 599u );
+   CHECK_EQUAL( db.count(table), 400u );
+   CHECK_EQUAL( db.count_secondary(0), 400u );
+   CHECK_EQUAL( db.count_secondary(1), 400u );
+
+   for( test_stream rows(code, scope, 0); rows; ) {
+      rows.erase();
+   }
+   CHECK_EQUAL( db.count(table), 0u );
+   CHECK_EQUAL( db.count_secondary(0), 0u );
+   CHECK_EQUAL( db.count_secondary(1), 0u );
+   CHECK_ASSERT( "Cannot erase past the last row", []() { test_stream(code, scope, 0).erase(); } );
+EOSIO_TEST_END
+
+// Extensions of a row are not carried over to the next row read into the buffer
+EOSIO_TEST_BEGIN(extension_stream_test)
+   setup_db(0);
+   test_row extended{ 1, 0, 0 };
+   extended.extra.emplace(42);
+   db.store(extended);
+   db.store(test_row_v0{ 2, 1, 1 });
+
+   test_stream rows(code, scope, 0);
+   CHECK_EQUAL( rows->extra.has_value(), true );
+   CHECK_EQUAL( rows->extra.value(), 42u );
+   ++rows;
+   CHECK_EQUAL( rows->id, 2u );
+   CHECK_EQUAL( rows->extra.has_value(), false );
+EOSIO_TEST_END
+
+int main(int argc, char* argv[]) {
+   bool verbose = false;
+   if( argc >= 2 && std::strcmp( argv[1], "-v" ) == 0 ) {
+      verbose = true;
+   }
+   silence_output(!verbose);
+
+   EOSIO_TEST(primary_stream_test);
+   EOSIO_TEST(secondary_stream_test);
+   EOSIO_TEST(erase_stream_test);
+   EOSIO_TEST(extension_stream_test);
+   return has_failed();
+}